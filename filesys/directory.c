@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <list.h>
+#include <hash.h>
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
@@ -12,13 +13,64 @@ struct dir {
 	off_t pos;                          /* Current position. */
 };
 
-/* A single directory entry. */
+/* A single directory entry.
+ * Project 4. DIR : 디렉터리 파일 전체가 이름을 키로 하는 해시 테이블 (선형 탐사)
+ * 한 번도 쓰이지 않은 슬롯은 모두 0, 삭제된 슬롯은 in_use만 false (inode_sector는 남겨 탐사를 이어감) */
 struct dir_entry {
 	disk_sector_t inode_sector;         /* Sector number of header. */
 	char name[NAME_MAX + 1];            /* Null terminated file name. */
 	bool in_use;                        /* In use or free? */
 };
 
+/* Project 4. DIR : 최근에 찾은 (디렉터리, 이름) -> inode 섹터 캐시 */
+struct dcache_entry {
+	disk_sector_t dir_sector;           /* Sector of the directory inode. */
+	disk_sector_t inode_sector;         /* Sector of the entry's inode. */
+	char name[NAME_MAX + 1];            /* Null terminated file name. */
+	bool valid;
+};
+
+static struct dcache_entry dcache[DCACHE_SIZE];
+
+/* Project 4. DIR : DIR 안의 NAME이 캐시될 엔트리 */
+static struct dcache_entry *
+dcache_slot (const struct dir *dir, const char *name) {
+	return &dcache[(hash_string (name) ^ hash_int (inode_get_inumber (dir->inode)))
+		% DCACHE_SIZE];
+}
+
+/* Project 4. DIR : 캐시에서 DIR 안의 NAME 검색 (없으면 NULL) */
+static struct dcache_entry *
+dcache_find (const struct dir *dir, const char *name) {
+	struct dcache_entry *d = dcache_slot (dir, name);
+	if (d->valid && d->dir_sector == inode_get_inumber (dir->inode)
+			&& !strcmp (d->name, name))
+		return d;
+	return NULL;
+}
+
+/* Project 4. DIR : DIR 안의 NAME이 INODE_SECTOR임을 캐시 (같은 슬롯의 이전 엔트리는 덮어씀) */
+static void
+dcache_insert (const struct dir *dir, const char *name, disk_sector_t inode_sector) {
+	struct dcache_entry *d = dcache_slot (dir, name);
+	d->dir_sector = inode_get_inumber (dir->inode);
+	d->inode_sector = inode_sector;
+	strlcpy (d->name, name, sizeof d->name);
+	d->valid = true;
+}
+
+/* Project 4. DIR : 디렉터리의 슬롯 수 */
+static size_t
+dir_slot_cnt (const struct dir *dir) {
+	return inode_length (dir->inode) / sizeof (struct dir_entry);
+}
+
+/* Project 4. DIR : NAME의 탐사를 시작할 슬롯 */
+static size_t
+dir_home_slot (const char *name, size_t slot_cnt) {
+	return hash_string (name) % slot_cnt;
+}
+
 /* Creates a directory with space for ENTRY_CNT entries in the
  * given SECTOR.  Returns true if successful, false on failure. */
 bool
@@ -80,13 +132,22 @@ static bool
 lookup (const struct dir *dir, const char *name,
 		struct dir_entry *ep, off_t *ofsp) {
 	struct dir_entry e;
-	size_t ofs;
+	size_t cnt, slot, i;
 
 	ASSERT (dir != NULL);
 	ASSERT (name != NULL);
 
-	for (ofs = 0; inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
-			ofs += sizeof e)
+	/* Project 4. DIR : NAME의 슬롯부터 탐사. 한 번도 쓰이지 않은 슬롯을 만나면 없는 이름 */
+	cnt = dir_slot_cnt (dir);
+	if (cnt == 0)
+		return false;
+	slot = dir_home_slot (name, cnt);
+	for (i = 0; i < cnt; i++, slot = (slot + 1) % cnt) {
+		off_t ofs = slot * sizeof e;
+		if (inode_read_at (dir->inode, &e, sizeof e, ofs) != sizeof e)
+			break;
+		if (!e.in_use && e.inode_sector == 0)
+			break;
 		if (e.in_use && !strcmp (name, e.name)) {
 			if (ep != NULL)
 				*ep = e;
@@ -94,6 +155,7 @@ lookup (const struct dir *dir, const char *name,
 				*ofsp = ofs;
 			return true;
 		}
+	}
 	return false;
 }
 
@@ -105,13 +167,19 @@ bool
 dir_lookup (const struct dir *dir, const char *name,
 		struct inode **inode) {
 	struct dir_entry e;
+	struct dcache_entry *d;
 
 	ASSERT (dir != NULL);
 	ASSERT (name != NULL);
 
-	if (lookup (dir, name, &e, NULL))
+	/* Project 4. DIR : 캐시에 있으면 디렉터리를 읽지 않음 */
+	d = dcache_find (dir, name);
+	if (d != NULL)
+		*inode = inode_open (d->inode_sector);
+	else if (lookup (dir, name, &e, NULL)) {
+		dcache_insert (dir, name, e.inode_sector);
 		*inode = inode_open (e.inode_sector);
-	else
+	} else
 		*inode = NULL;
 
 	return *inode != NULL;
@@ -126,7 +194,8 @@ dir_lookup (const struct dir *dir, const char *name,
 bool
 dir_add (struct dir *dir, const char *name, disk_sector_t inode_sector) {
 	struct dir_entry e;
-	off_t ofs;
+	off_t ofs = 0;
+	size_t cnt, slot, i;
 	bool success = false;
 
 	ASSERT (dir != NULL);
@@ -141,22 +210,33 @@ dir_add (struct dir *dir, const char *name, disk_sector_t inode_sector) {
 		goto done;
 
 	/* Set OFS to offset of free slot.
-	 * If there are no free slots, then it will be set to the
-	 * current end-of-file.
+	 * Project 4. DIR : NAME의 슬롯부터 탐사해 비어 있거나 삭제된 첫 슬롯 사용
+	 * 빈 슬롯이 없으면 (디렉터리가 가득 참) 실패
 
 	 * inode_read_at() will only return a short read at end of file.
 	 * Otherwise, we'd need to verify that we didn't get a short
 	 * read due to something intermittent such as low memory. */
-	for (ofs = 0; inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
-			ofs += sizeof e)
+	cnt = dir_slot_cnt (dir);
+	if (cnt == 0)
+		goto done;
+	slot = dir_home_slot (name, cnt);
+	for (i = 0; i < cnt; i++, slot = (slot + 1) % cnt) {
+		ofs = slot * sizeof e;
+		if (inode_read_at (dir->inode, &e, sizeof e, ofs) != sizeof e)
+			goto done;
 		if (!e.in_use)
 			break;
+	}
+	if (i == cnt)
+		goto done;
 
 	/* Write slot. */
 	e.in_use = true;
 	strlcpy (e.name, name, sizeof e.name);
 	e.inode_sector = inode_sector;
 	success = inode_write_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
+	if (success)
+		dcache_insert (dir, name, inode_sector);
 
 done:
 	return success;
@@ -168,6 +248,7 @@ done:
 bool
 dir_remove (struct dir *dir, const char *name) {
 	struct dir_entry e;
+	struct dcache_entry *d;
 	struct inode *inode = NULL;
 	bool success = false;
 	off_t ofs;
@@ -184,10 +265,14 @@ dir_remove (struct dir *dir, const char *name) {
 	if (inode == NULL)
 		goto done;
 
-	/* Erase directory entry. */
+	/* Erase directory entry.
+	 * Project 4. DIR : inode_sector는 남겨 두어 뒤쪽 슬롯으로의 탐사가 끊기지 않게 함 */
 	e.in_use = false;
 	if (inode_write_at (dir->inode, &e, sizeof e, ofs) != sizeof e)
 		goto done;
+	d = dcache_find (dir, name);
+	if (d != NULL)
+		d->valid = false;
 
 	/* Remove inode. */
 	inode_remove (inode);
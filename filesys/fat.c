@@ -3,13 +3,15 @@
 #include "filesys/filesys.h"
 #include "threads/malloc.h"
 #include "threads/synch.h"
+#include <bitmap.h>
+#include <round.h>
 #include <stdio.h>
 #include <string.h>
 
 /* Should be less than DISK_SECTOR_SIZE */
 struct fat_boot {
 	unsigned int magic;
-	unsigned int sectors_per_cluster; /* Fixed to 1 */
+	unsigned int sectors_per_cluster; /* Set at format time (fat_format_spc) */
 	unsigned int total_sectors;
 	unsigned int fat_start;
 	unsigned int fat_sectors; /* Size of FAT in sectors. */
@@ -19,17 +21,31 @@ struct fat_boot {
 /* FAT FS */
 struct fat_fs {
 	struct fat_boot bs;
-	unsigned int *fat;
+	cluster_t **fat;				/* Project 4. DFAT : FAT 섹터별 버퍼 (NULL이면 아직 읽지 않음). */
+	struct bitmap *fat_dirty;		/* Project 4. DFAT : 읽은 뒤 바뀐 FAT 섹터. */
 	unsigned int fat_length;
 	disk_sector_t data_start;
 	cluster_t last_clst;
 	struct lock write_lock;
+
+	/* Project 4. FREE : 빈 클러스터 인덱스
+	 * 사용 중인 클러스터 비트맵과 그룹 (FAT 한 섹터 분량)별 빈 클러스터 수
+	 * Project 4. DFAT : FAT 섹터를 읽을 때 해당 그룹을 채움 (읽지 않은 그룹은 모두 사용 중으로 취급) */
+	struct bitmap *used;
+	size_t *group_free;
+	size_t group_cnt;
 };
 
+/* Project 4. FREE : 그룹 하나의 클러스터 수 (FAT 한 섹터에 담기는 엔트리 수) */
+#define FAT_GROUP_CLUSTERS (DISK_SECTOR_SIZE / sizeof (cluster_t))
+
 static struct fat_fs *fat_fs;
 
+unsigned int fat_format_spc = SECTORS_PER_CLUSTER;
+
 void fat_boot_create (void);
 void fat_fs_init (void);
+static void fat_table_init (void);
 
 void
 fat_init (void) {
@@ -51,35 +67,13 @@ fat_init (void) {
 	fat_fs_init ();
 }
 
+/* Project 4. DFAT : FAT는 섹터 단위로 처음 접근할 때 읽으므로 마운트 시에는 디스크를 읽지 않음 */
 void
 fat_open (void) {
-	fat_fs->fat = calloc (fat_fs->fat_length, sizeof (cluster_t));
-	if (fat_fs->fat == NULL)
-		PANIC ("FAT load failed");
-
-	// Load FAT directly from the disk
-	uint8_t *buffer = (uint8_t *) fat_fs->fat;
-	off_t bytes_read = 0;
-	off_t bytes_left = sizeof (fat_fs->fat);
-	const off_t fat_size_in_bytes = fat_fs->fat_length * sizeof (cluster_t);
-	for (unsigned i = 0; i < fat_fs->bs.fat_sectors; i++) {
-		bytes_left = fat_size_in_bytes - bytes_read;
-		if (bytes_left >= DISK_SECTOR_SIZE) {
-			disk_read (filesys_disk, fat_fs->bs.fat_start + i,
-			           buffer + bytes_read);
-			bytes_read += DISK_SECTOR_SIZE;
-		} else {
-			uint8_t *bounce = malloc (DISK_SECTOR_SIZE);
-			if (bounce == NULL)
-				PANIC ("FAT load failed");
-			disk_read (filesys_disk, fat_fs->bs.fat_start + i, bounce);
-			memcpy (buffer + bytes_read, bounce, bytes_left);
-			bytes_read += bytes_left;
-			free (bounce);
-		}
-	}
+	fat_table_init ();
 }
 
+/* Project 4. DFAT : 바뀐 FAT 섹터만 디스크에 기록 */
 void
 fat_close (void) {
 	// Write FAT boot sector
@@ -90,27 +84,14 @@ fat_close (void) {
 	disk_write (filesys_disk, FAT_BOOT_SECTOR, bounce);
 	free (bounce);
 
-	// Write FAT directly to the disk
-	uint8_t *buffer = (uint8_t *) fat_fs->fat;
-	off_t bytes_wrote = 0;
-	off_t bytes_left = sizeof (fat_fs->fat);
-	const off_t fat_size_in_bytes = fat_fs->fat_length * sizeof (cluster_t);
-	for (unsigned i = 0; i < fat_fs->bs.fat_sectors; i++) {
-		bytes_left = fat_size_in_bytes - bytes_wrote;
-		if (bytes_left >= DISK_SECTOR_SIZE) {
-			disk_write (filesys_disk, fat_fs->bs.fat_start + i,
-			            buffer + bytes_wrote);
-			bytes_wrote += DISK_SECTOR_SIZE;
-		} else {
-			bounce = calloc (1, DISK_SECTOR_SIZE);
-			if (bounce == NULL)
-				PANIC ("FAT close failed");
-			memcpy (bounce, buffer + bytes_wrote, bytes_left);
-			disk_write (filesys_disk, fat_fs->bs.fat_start + i, bounce);
-			bytes_wrote += bytes_left;
-			free (bounce);
+	// Write dirty FAT sectors to the disk
+	lock_acquire (&fat_fs->write_lock);
+	for (size_t i = 0; i < fat_fs->bs.fat_sectors; i++)
+		if (bitmap_test (fat_fs->fat_dirty, i)) {
+			disk_write (filesys_disk, fat_fs->bs.fat_start + i, fat_fs->fat[i]);
+			bitmap_reset (fat_fs->fat_dirty, i);
 		}
-	}
+	lock_release (&fat_fs->write_lock);
 }
 
 void
@@ -120,18 +101,20 @@ fat_create (void) {
 	fat_fs_init ();
 
 	// Create FAT table
-	fat_fs->fat = calloc (fat_fs->fat_length, sizeof (cluster_t));
-	if (fat_fs->fat == NULL)
-		PANIC ("FAT creation failed");
+	// Project 4. DFAT : 디스크의 FAT를 모두 0으로 채운 뒤 다른 섹터처럼 필요할 때 읽음
+	uint8_t *buf = calloc (1, DISK_SECTOR_SIZE);
+	if (buf == NULL)
+		PANIC ("FAT create failed due to OOM");
+	for (size_t i = 0; i < fat_fs->bs.fat_sectors; i++)
+		disk_write (filesys_disk, fat_fs->bs.fat_start + i, buf);
+	fat_table_init ();
 
 	// Set up ROOT_DIR_CLST
 	fat_put (ROOT_DIR_CLUSTER, EOChain);
 
 	// Fill up ROOT_DIR_CLUSTER region with 0
-	uint8_t *buf = calloc (1, DISK_SECTOR_SIZE);
-	if (buf == NULL)
-		PANIC ("FAT create failed due to OOM");
-	disk_write (filesys_disk, cluster_to_sector (ROOT_DIR_CLUSTER), buf);
+	for (unsigned int i = 0; i < fat_fs->bs.sectors_per_cluster; i++)
+		disk_write (filesys_disk, cluster_to_sector (ROOT_DIR_CLUSTER) + i, buf);
 	free (buf);
 }
 
@@ -139,10 +122,10 @@ void
 fat_boot_create (void) {
 	unsigned int fat_sectors =
 	    (disk_size (filesys_disk) - 1)
-	    / (DISK_SECTOR_SIZE / sizeof (cluster_t) * SECTORS_PER_CLUSTER + 1) + 1;
+	    / (DISK_SECTOR_SIZE / sizeof (cluster_t) * fat_format_spc + 1) + 1;
 	fat_fs->bs = (struct fat_boot){
 	    .magic = FAT_MAGIC,
-	    .sectors_per_cluster = SECTORS_PER_CLUSTER,
+	    .sectors_per_cluster = fat_format_spc,
 	    .total_sectors = disk_size (filesys_disk),
 	    .fat_start = 1,
 	    .fat_sectors = fat_sectors,
@@ -153,6 +136,13 @@ fat_boot_create (void) {
 void
 fat_fs_init (void) {
 	/* TODO: Your code goes here. */
+	/* Project 4. FAT : 부트 섹터, FAT 뒤가 데이터 영역. 클러스터 0은 빈 칸 표시로 쓰므로
+	 * 클러스터 1이 데이터 영역의 첫 클러스터 */
+	fat_fs->data_start = fat_fs->bs.fat_start + fat_fs->bs.fat_sectors;
+	fat_fs->fat_length = (fat_fs->bs.total_sectors - fat_fs->data_start)
+		/ fat_fs->bs.sectors_per_cluster + 1;
+	fat_fs->last_clst = ROOT_DIR_CLUSTER;
+	lock_init (&fat_fs->write_lock);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -165,6 +155,153 @@ fat_fs_init (void) {
 cluster_t
 fat_create_chain (cluster_t clst) {
 	/* TODO: Your code goes here. */
+	return fat_create_chain_multiple (clst, 1);
+}
+
+/* Project 4. DFAT : 읽은 FAT 섹터가 없는 상태로 메모리 구조 초기화 (이전에 쓰던 것은 해제) */
+static void
+fat_table_init (void) {
+	if (fat_fs->fat != NULL)
+		for (size_t i = 0; i < fat_fs->bs.fat_sectors; i++)
+			free (fat_fs->fat[i]);
+	free (fat_fs->fat);
+	bitmap_destroy (fat_fs->fat_dirty);
+	bitmap_destroy (fat_fs->used);
+	free (fat_fs->group_free);
+
+	fat_fs->group_cnt = DIV_ROUND_UP (fat_fs->fat_length, FAT_GROUP_CLUSTERS);
+	fat_fs->fat = calloc (fat_fs->bs.fat_sectors, sizeof *fat_fs->fat);
+	fat_fs->fat_dirty = bitmap_create (fat_fs->bs.fat_sectors);
+	fat_fs->used = bitmap_create (fat_fs->fat_length);
+	fat_fs->group_free = calloc (fat_fs->group_cnt, sizeof *fat_fs->group_free);
+	if (fat_fs->fat == NULL || fat_fs->fat_dirty == NULL
+			|| fat_fs->used == NULL || fat_fs->group_free == NULL)
+		PANIC ("FAT load failed");
+	bitmap_set_all (fat_fs->used, true);
+}
+
+/* Project 4. DFAT : IDX번째 FAT 섹터를 읽고 그 그룹의 빈 클러스터 인덱스 구성 (write_lock 필요) */
+static void
+fat_load (size_t idx) {
+	cluster_t *entries = malloc (DISK_SECTOR_SIZE);
+	if (entries == NULL)
+		PANIC ("FAT load failed");
+	disk_read (filesys_disk, fat_fs->bs.fat_start + idx, entries);
+	fat_fs->fat[idx] = entries;
+
+	for (size_t i = 0; i < FAT_GROUP_CLUSTERS; i++) {
+		cluster_t c = idx * FAT_GROUP_CLUSTERS + i;
+		if (c >= fat_fs->fat_length)
+			break;
+		if (c != 0 && entries[i] == 0) {
+			bitmap_reset (fat_fs->used, c);
+			fat_fs->group_free[idx]++;
+		}
+	}
+}
+
+/* Project 4. DFAT : CLST의 FAT 엔트리 주소 (처음 접근하는 FAT 섹터는 디스크에서 읽음, write_lock 필요) */
+static cluster_t *
+fat_entry (cluster_t clst) {
+	ASSERT (clst < fat_fs->fat_length);
+	size_t idx = clst / FAT_GROUP_CLUSTERS;
+	if (fat_fs->fat[idx] == NULL)
+		fat_load (idx);
+	return &fat_fs->fat[idx][clst % FAT_GROUP_CLUSTERS];
+}
+
+/* Project 4. FREE : CLST의 FAT 엔트리를 VAL로 바꾸고 인덱스 갱신 (write_lock 필요, 인덱스 구성 후) */
+static void
+fat_set (cluster_t clst, cluster_t val) {
+	ASSERT (clst != 0 && clst < fat_fs->fat_length);
+	cluster_t *entry = fat_entry (clst);
+	bool was_used = *entry != 0;
+	*entry = val;
+	bitmap_mark (fat_fs->fat_dirty, clst / FAT_GROUP_CLUSTERS);
+	if (was_used != (val != 0)) {
+		bitmap_set (fat_fs->used, clst, val != 0);
+		if (val != 0)
+			fat_fs->group_free[clst / FAT_GROUP_CLUSTERS]--;
+		else
+			fat_fs->group_free[clst / FAT_GROUP_CLUSTERS]++;
+	}
+}
+
+/* Project 4. FREE : 빈 클러스터 하나 검색 (없으면 0, write_lock 필요)
+ * 마지막으로 할당한 클러스터의 그룹부터 빈 클러스터가 있는 그룹만 확인 */
+static cluster_t
+fat_find_free (void) {
+	size_t g0 = fat_fs->last_clst / FAT_GROUP_CLUSTERS;
+	for (size_t i = 0; i < fat_fs->group_cnt; i++) {
+		size_t g = (g0 + i) % fat_fs->group_cnt;
+		if (fat_fs->fat[g] == NULL)
+			fat_load (g);
+		if (fat_fs->group_free[g] == 0)
+			continue;
+		size_t c = bitmap_scan (fat_fs->used, g * FAT_GROUP_CLUSTERS, 1, false);
+		ASSERT (c != BITMAP_ERROR);
+		return c;
+	}
+	return 0;
+}
+
+/* Project 4. FREE : 연속된 빈 클러스터 CNT개의 시작 검색 (없으면 0, write_lock 필요)
+ * Project 4. DFAT : 마지막으로 할당한 그룹부터 그룹 단위로 읽어 가며 그 그룹에서 시작하는 구간 확인 */
+static cluster_t
+fat_find_run (size_t cnt) {
+	size_t g0 = fat_fs->last_clst / FAT_GROUP_CLUSTERS;
+	size_t span = DIV_ROUND_UP (cnt, FAT_GROUP_CLUSTERS);
+
+	for (size_t i = 0; i < fat_fs->group_cnt; i++) {
+		size_t g = (g0 + i) % fat_fs->group_cnt;
+		for (size_t j = g; j <= g + span && j < fat_fs->group_cnt; j++)
+			if (fat_fs->fat[j] == NULL)
+				fat_load (j);
+
+		size_t end = (g + 1) * FAT_GROUP_CLUSTERS;
+		for (size_t c = g * FAT_GROUP_CLUSTERS; c < end && c + cnt <= fat_fs->fat_length; c++)
+			if (!bitmap_contains (fat_fs->used, c, cnt, true))
+				return c;
+	}
+	return 0;
+}
+
+/* Project 4. FREE : CLST 뒤에 CNT개의 클러스터를 이어 붙이고 첫 번째 새 클러스터 리턴
+ * CLST가 0이면 새 체인을 만듦. 가능하면 디스크에서 연속된 클러스터로 할당
+ * 공간이 부족하면 아무것도 붙이지 않고 0 리턴 */
+cluster_t
+fat_create_chain_multiple (cluster_t clst, size_t cnt) {
+	ASSERT (cnt > 0);
+
+	lock_acquire (&fat_fs->write_lock);
+	cluster_t first = 0, prev = 0;
+	cluster_t run = cnt > 1 ? fat_find_run (cnt) : 0;
+
+	for (size_t i = 0; i < cnt; i++) {
+		cluster_t new = run != 0 ? run + i : fat_find_free ();
+		if (new == 0) {
+			/* 공간 부족 : 이번에 할당한 클러스터를 모두 되돌림 */
+			for (cluster_t c = first; c != 0 && c != EOChain; ) {
+				cluster_t next = *fat_entry (c);
+				fat_set (c, 0);
+				c = next;
+			}
+			first = 0;
+			break;
+		}
+		fat_set (new, EOChain);
+		if (prev != 0)
+			fat_set (prev, new);
+		else
+			first = new;
+		prev = new;
+		fat_fs->last_clst = new;
+	}
+
+	if (first != 0 && clst != 0)
+		fat_set (clst, first);
+	lock_release (&fat_fs->write_lock);
+	return first;
 }
 
 /* Remove the chain of clusters starting from CLST.
@@ -172,22 +309,54 @@ fat_create_chain (cluster_t clst) {
 void
 fat_remove_chain (cluster_t clst, cluster_t pclst) {
 	/* TODO: Your code goes here. */
+	lock_acquire (&fat_fs->write_lock);
+	if (pclst != 0)
+		fat_set (pclst, EOChain);
+	while (clst != 0 && clst != EOChain) {
+		cluster_t next = *fat_entry (clst);
+		fat_set (clst, 0);
+		clst = next;
+	}
+	lock_release (&fat_fs->write_lock);
 }
 
 /* Update a value in the FAT table. */
 void
 fat_put (cluster_t clst, cluster_t val) {
 	/* TODO: Your code goes here. */
+	lock_acquire (&fat_fs->write_lock);
+	fat_set (clst, val);
+	lock_release (&fat_fs->write_lock);
 }
 
 /* Fetch a value in the FAT table. */
 cluster_t
 fat_get (cluster_t clst) {
 	/* TODO: Your code goes here. */
+	lock_acquire (&fat_fs->write_lock);
+	cluster_t val = *fat_entry (clst);
+	lock_release (&fat_fs->write_lock);
+	return val;
 }
 
 /* Covert a cluster # to a sector number. */
 disk_sector_t
 cluster_to_sector (cluster_t clst) {
 	/* TODO: Your code goes here. */
+	ASSERT (clst != 0);
+	return fat_fs->data_start + (clst - 1) * fat_fs->bs.sectors_per_cluster;
 }
+
+/* Project 4. FAT : 섹터 번호를 그 섹터가 속한 클러스터 번호로 변환 */
+cluster_t
+sector_to_cluster (disk_sector_t sector) {
+	ASSERT (sector >= fat_fs->data_start);
+	return (sector - fat_fs->data_start) / fat_fs->bs.sectors_per_cluster + 1;
+}
+
+/* Project 4. FAT : 클러스터 하나의 섹터 수 */
+unsigned int
+fat_sectors_per_cluster (void) {
+	return fat_fs->bs.sectors_per_cluster;
+}
+
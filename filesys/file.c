@@ -2,6 +2,7 @@
 #include <debug.h>
 #include "filesys/inode.h"
 #include "threads/malloc.h"
+#include "filesys/page_cache.h"
 
 /* Opens a file for the given INODE, of which it takes ownership,
  * and returns the new file.  Returns a null pointer if an
@@ -17,6 +18,11 @@ file_open (struct inode *inode) {
 		/* Proj 2-7. Extra */
 		file->dupCount = 0;				// 초기화 (구조체가 변경되면 항상 초기화를!)
 
+		/* Project 4. RA : 처음 0부터 읽으면 순차 읽기로 간주 */
+		file->ra_next = 0;
+		file->ra_end = 0;
+		file->ra_window = 0;
+
 		return file;
 	} else {
 		inode_close (inode);
@@ -64,6 +70,33 @@ file_get_inode (struct file *file) {
 	return file->inode;
 }
 
+/* Project 4. RA : OFS부터 BYTES_READ 바이트를 읽은 뒤 호출
+ * 이전 읽기에 이어지는 읽기라면 창을 두 배로 늘리고 (최대 RA_MAX_WINDOW),
+ * 아니라면 창을 닫음. 창 안에서 아직 요청하지 않은 섹터만 미리 읽도록 요청 */
+static void
+file_readahead (struct file *file, off_t ofs, off_t bytes_read) {
+	if (bytes_read <= 0)
+		return;
+
+	if (ofs == file->ra_next) {
+		file->ra_window = file->ra_window == 0 ? RA_MIN_WINDOW
+				: file->ra_window * 2 < RA_MAX_WINDOW ? file->ra_window * 2 : RA_MAX_WINDOW;
+	} else {
+		file->ra_window = 0;
+		file->ra_end = 0;
+	}
+	file->ra_next = ofs + bytes_read;
+	if (file->ra_window == 0)
+		return;
+
+	off_t start = file->ra_end > file->ra_next ? file->ra_end : file->ra_next;
+	off_t end = file->ra_next + file->ra_window * DISK_SECTOR_SIZE;
+	if (start < end) {
+		inode_readahead (file->inode, end - start, start);
+		file->ra_end = end;
+	}
+}
+
 /* Reads SIZE bytes from FILE into BUFFER,
  * starting at the file's current position.
  * Returns the number of bytes actually read,
@@ -72,6 +105,7 @@ file_get_inode (struct file *file) {
 off_t
 file_read (struct file *file, void *buffer, off_t size) {
 	off_t bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
+	file_readahead (file, file->pos, bytes_read);
 	file->pos += bytes_read;
 	return bytes_read;
 }
@@ -83,7 +117,9 @@ file_read (struct file *file, void *buffer, off_t size) {
  * The file's current position is unaffected. */
 off_t
 file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs) {
-	return inode_read_at (file->inode, buffer, size, file_ofs);
+	off_t bytes_read = inode_read_at (file->inode, buffer, size, file_ofs);
+	file_readahead (file, file_ofs, bytes_read);
+	return bytes_read;
 }
 
 /* Writes SIZE bytes from BUFFER into FILE,
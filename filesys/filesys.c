@@ -7,6 +7,7 @@
 #include "filesys/inode.h"
 #include "filesys/directory.h"
 #include "devices/disk.h"
+#include "filesys/page_cache.h"
 
 /* The disk that contains the file system. */
 struct disk *filesys_disk;
@@ -21,6 +22,7 @@ filesys_init (bool format) {
 	if (filesys_disk == NULL)
 		PANIC ("hd0:1 (hdb) not present, file system initialization failed");
 
+	page_cache_init ();				// Project 4. BC : 이후의 섹터 읽기/쓰기는 버퍼 캐시를 거침
 	inode_init ();
 
 #ifdef EFILESYS
@@ -51,6 +53,7 @@ filesys_done (void) {
 #else
 	free_map_close ();
 #endif
+	page_cache_flush ();			// Project 4. BC : 캐시에 남은 dirty 섹터 기록
 }
 
 /* Creates a file named NAME with the given INITIAL_SIZE.
@@ -110,10 +113,12 @@ do_format (void) {
 #ifdef EFILESYS
 	/* Create FAT and save it to the disk. */
 	fat_create ();
+	if (!dir_create (ROOT_DIR_SECTOR, ROOT_DIR_ENTRIES))	// Project 4. FAT : 루트 디렉터리 생성
+		PANIC ("root directory creation failed");
 	fat_close ();
 #else
 	free_map_create ();
-	if (!dir_create (ROOT_DIR_SECTOR, 16))
+	if (!dir_create (ROOT_DIR_SECTOR, ROOT_DIR_ENTRIES))
 		PANIC ("root directory creation failed");
 	free_map_close ();
 #endif
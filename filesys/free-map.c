@@ -5,6 +5,26 @@
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
 
+#ifdef EFILESYS
+#include "filesys/fat.h"
+
+/* Project 4. FAT : FAT 파일 시스템에서는 FAT가 빈 공간을 관리하므로
+ * inode 섹터 할당과 해제만 클러스터 하나 단위로 FAT에 위임 */
+bool
+free_map_allocate (size_t cnt, disk_sector_t *sectorp) {
+	ASSERT (cnt <= fat_sectors_per_cluster ());
+	cluster_t clst = fat_create_chain (0);
+	if (clst == 0)
+		return false;
+	*sectorp = cluster_to_sector (clst);
+	return true;
+}
+
+void
+free_map_release (disk_sector_t sector, size_t cnt UNUSED) {
+	fat_remove_chain (sector_to_cluster (sector), 0);
+}
+#else
 static struct file *free_map_file;   /* Free map file. */
 static struct bitmap *free_map;      /* Free map, one bit per disk sector. */
 
@@ -75,3 +95,4 @@ free_map_create (void) {
 	if (!bitmap_write (free_map, free_map_file))
 		PANIC ("can't write free map");
 }
+#endif
@@ -1,22 +1,34 @@
 #include "filesys/inode.h"
 #include <list.h>
+#include <hash.h>
 #include <debug.h>
 #include <round.h>
 #include <string.h>
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
+#include "filesys/page_cache.h"
 #include "threads/malloc.h"
+#ifdef EFILESYS
+#include "filesys/fat.h"
+#endif
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
 
+/* Project 4. INLINE : inode 섹터 안에 직접 저장하는 파일의 최대 크기 (데이터 섹터 하나보다 작음) */
+#define INODE_INLINE_MAX 480
+
 /* On-disk inode.
  * Must be exactly DISK_SECTOR_SIZE bytes long. */
 struct inode_disk {
-	disk_sector_t start;                /* First data sector. */
+	disk_sector_t start;                /* First data sector (first cluster on FAT). */
 	off_t length;                       /* File size in bytes. */
 	unsigned magic;                     /* Magic number. */
-	uint32_t unused[125];               /* Not used. */
+	uint32_t cluster_cnt;               /* Project 4. DALLOC : 체인의 클러스터 수 (FAT). */
+	uint32_t reserved_cnt;              /* Project 4. DALLOC : fallocate로 예약한 클러스터 수 (FAT). */
+	uint32_t is_inline;                 /* Project 4. INLINE : 데이터가 inline_data에 있는지 여부. */
+	uint8_t inline_data[INODE_INLINE_MAX]; /* Project 4. INLINE : 작은 파일의 데이터. */
+	uint32_t unused[2];                 /* Not used. */
 };
 
 /* Returns the number of sectors to allocate for an inode SIZE
@@ -26,37 +38,320 @@ bytes_to_sectors (off_t size) {
 	return DIV_ROUND_UP (size, DISK_SECTOR_SIZE);
 }
 
+/* Project 4. IC : 마지막으로 닫힌 뒤에도 메모리에 남겨 두는 inode 최대 수 */
+#define INODE_CACHE_SIZE 64
+
+/* Project 4. DALLOC : 파일이 커질 때 필요한 만큼에 더해 미리 할당하는 최대 클러스터 수 */
+#define PREALLOC_MAX_CLUSTERS 64
+
+#ifdef EFILESYS
+/* Project 4. EXT : 파일 내 클러스터 [idx, idx + len)이 디스크 클러스터 [clst, clst + len)에 연속으로 있음 */
+struct extent {
+	size_t idx;                         /* First cluster index within the file. */
+	cluster_t clst;                     /* First cluster on disk. */
+	size_t len;                         /* Number of clusters. */
+};
+#endif
+
 /* In-memory inode. */
 struct inode {
-	struct list_elem elem;              /* Element in inode list. */
+	struct hash_elem elem;              /* Element in inode table. */
+	struct list_elem lru_elem;          /* Project 4. IC : 닫힌 inode LRU 리스트 원소. */
 	disk_sector_t sector;               /* Sector number of disk location. */
 	int open_cnt;                       /* Number of openers. */
 	bool removed;                       /* True if deleted, false otherwise. */
 	int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
 	struct inode_disk data;             /* Inode content. */
+#ifdef EFILESYS
+	/* Project 4. EXT : 지금까지 따라간 체인 앞부분의 익스텐트 (파일 내 위치 순) */
+	struct extent *extents;
+	size_t extent_cnt, extent_cap;
+#endif
 };
 
+#ifdef EFILESYS
+/* Project 4. EXT : 파일 내 CNT번째 클러스터부터의 익스텐트를 버림 (체인 뒷부분을 잘랐을 때)
+ * 체인은 그 체인을 가진 inode만 자르므로 다른 inode의 캐시는 그대로 유효 */
+static void
+extent_truncate (struct inode *inode, size_t cnt) {
+	while (inode->extent_cnt > 0) {
+		struct extent *last = &inode->extents[inode->extent_cnt - 1];
+		if (last->idx + last->len <= cnt)
+			break;
+		if (last->idx < cnt) {
+			last->len = cnt - last->idx;
+			break;
+		}
+		inode->extent_cnt--;
+	}
+}
+
+/* Project 4. EXT : 파일 내 IDX번째 클러스터가 CLST임을 기록 (IDX는 캐시된 구간 바로 다음)
+ * 마지막 익스텐트와 이어지면 늘리고 아니면 새 익스텐트 추가. 메모리가 없으면 false */
+static bool
+extent_append (struct inode *inode, size_t idx, cluster_t clst) {
+	struct extent *last = inode->extent_cnt > 0 ? &inode->extents[inode->extent_cnt - 1] : NULL;
+	if (last != NULL && last->clst + last->len == clst) {
+		last->len++;
+		return true;
+	}
+
+	if (inode->extent_cnt == inode->extent_cap) {
+		size_t cap = inode->extent_cap > 0 ? inode->extent_cap * 2 : 4;
+		struct extent *extents = realloc (inode->extents, cap * sizeof *extents);
+		if (extents == NULL)
+			return false;
+		inode->extents = extents;
+		inode->extent_cap = cap;
+	}
+	inode->extents[inode->extent_cnt++] = (struct extent) { idx, clst, 1 };
+	return true;
+}
+
+/* Project 4. EXT : 파일 내 IDX번째 클러스터 리턴 (없으면 0)
+ * 캐시된 구간이면 이분 탐색, 아니면 캐시된 마지막 클러스터부터 체인을 따라가며 캐시를 늘림 */
+static cluster_t
+inode_cluster_at (struct inode *inode, size_t idx) {
+	size_t lo = 0, hi = inode->extent_cnt;
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		struct extent *e = &inode->extents[mid];
+		if (idx < e->idx)
+			hi = mid;
+		else if (idx >= e->idx + e->len)
+			lo = mid + 1;
+		else
+			return e->clst + (idx - e->idx);
+	}
+
+	cluster_t clst;
+	size_t next;
+	if (inode->extent_cnt == 0) {
+		clst = inode->data.start;
+		next = 0;
+	} else {
+		struct extent *last = &inode->extents[inode->extent_cnt - 1];
+		clst = fat_get (last->clst + last->len - 1);
+		next = last->idx + last->len;
+	}
+
+	bool caching = true;
+	for (; clst != 0 && clst != EOChain; clst = fat_get (clst), next++) {
+		if (caching && !extent_append (inode, next, clst))
+			caching = false;								// 캐시는 항상 체인의 앞부분만 담음
+		if (next == idx)
+			return clst;
+	}
+	return 0;
+}
+
+/* Project 4. FAT : CNT개 클러스터 체인을 만들어 0으로 채우고 첫 클러스터를 *STARTP에 저장
+ * (CNT가 0이면 0). 한 번에 요청해 가능하면 연속된 클러스터를 받음 */
+static bool
+inode_allocate_chain (size_t cnt, cluster_t *startp) {
+	static char zeros[DISK_SECTOR_SIZE];
+	cluster_t start = 0;
+
+	if (cnt > 0) {
+		start = fat_create_chain_multiple (0, cnt);
+		if (start == 0)
+			return false;
+	}
+	for (cluster_t clst = start; clst != 0 && clst != EOChain; clst = fat_get (clst))
+		for (unsigned j = 0; j < fat_sectors_per_cluster (); j++)
+			page_cache_write (cluster_to_sector (clst) + j, zeros, 0, DISK_SECTOR_SIZE);
+	*startp = start;
+	return true;
+}
+
+static disk_sector_t byte_to_sector (struct inode *inode, off_t pos);
+
+/* Project 4. DALLOC : LENGTH 바이트를 담는 데 필요한 클러스터 수 */
+static size_t
+bytes_to_clusters (off_t length) {
+	return DIV_ROUND_UP (bytes_to_sectors (length), fat_sectors_per_cluster ());
+}
+
+/* Project 4. DALLOC : 체인이 CNT개 이상의 클러스터를 가지도록 늘림
+ * 부족한 만큼에 EXTRA개를 더해 한 번에 요청해 연속된 클러스터를 받고,
+ * 공간이 부족하면 부족한 만큼만 다시 요청. 새 클러스터는 0으로 채우지 않음 (파일 끝 뒤는 읽지 않음) */
+static bool
+inode_extend_chain (struct inode *inode, size_t cnt, size_t extra) {
+	size_t have = inode->data.cluster_cnt;
+	if (cnt <= have)
+		return true;
+
+	cluster_t last = have > 0 ? inode_cluster_at (inode, have - 1) : 0;
+	ASSERT (have == 0 || last != 0);
+	cluster_t first = fat_create_chain_multiple (last, cnt - have + extra);
+	if (first == 0 && extra > 0) {
+		extra = 0;
+		first = fat_create_chain_multiple (last, cnt - have);
+	}
+	if (first == 0)
+		return false;
+
+	if (have == 0)
+		inode->data.start = first;
+	inode->data.cluster_cnt = cnt + extra;
+	return true;
+}
+
+/* Project 4. DALLOC : 파일 길이를 LENGTH로 늘림
+ * 파일 크기에 비례해 (최대 PREALLOC_MAX_CLUSTERS) 미리 할당해 두므로 여러 파일에 번갈아 덧붙여도
+ * 각 파일이 큰 연속 구간을 받음. 이전 끝부터 ZERO_END까지는 0으로 채움 */
+static bool
+inode_grow (struct inode *inode, off_t length, off_t zero_end) {
+	static char zeros[DISK_SECTOR_SIZE];
+	size_t cnt = bytes_to_clusters (length);
+	size_t extra = cnt < PREALLOC_MAX_CLUSTERS ? cnt : PREALLOC_MAX_CLUSTERS;
+
+	if (!inode_extend_chain (inode, cnt, extra))
+		return false;
+
+	off_t pos = inode->data.length;
+	inode->data.length = length;
+	while (pos < zero_end) {
+		int sector_ofs = pos % DISK_SECTOR_SIZE;
+		int chunk_size = DISK_SECTOR_SIZE - sector_ofs;
+		if (chunk_size > zero_end - pos)
+			chunk_size = zero_end - pos;
+		page_cache_write (byte_to_sector (inode, pos), zeros, sector_ofs, chunk_size);
+		pos += chunk_size;
+	}
+	page_cache_write (inode->sector, &inode->data, 0, DISK_SECTOR_SIZE);
+	return true;
+}
+
+/* Project 4. DALLOC : 마지막으로 닫힐 때 미리 할당했지만 쓰지 않은 클러스터 반환 (예약한 만큼은 유지) */
+static void
+inode_trim (struct inode *inode) {
+	size_t keep = bytes_to_clusters (inode->data.length);
+	if (keep < inode->data.reserved_cnt)
+		keep = inode->data.reserved_cnt;
+	if (keep >= inode->data.cluster_cnt)
+		return;
+
+	if (keep == 0) {
+		fat_remove_chain (inode->data.start, 0);
+		inode->data.start = 0;
+	} else
+		fat_remove_chain (inode_cluster_at (inode, keep), inode_cluster_at (inode, keep - 1));
+	extent_truncate (inode, keep);								// Project 4. EXT : 잘린 부분만 캐시에서 제거
+	inode->data.cluster_cnt = keep;
+	page_cache_write (inode->sector, &inode->data, 0, DISK_SECTOR_SIZE);
+}
+
+/* Project 4. INLINE : inode 섹터에 저장된 데이터를 클러스터로 옮김 (INODE_INLINE_MAX를 넘게 커질 때) */
+static bool
+inode_uninline (struct inode *inode) {
+	uint8_t sector[DISK_SECTOR_SIZE];
+	off_t length = inode->data.length;
+
+	if (!inode_extend_chain (inode, bytes_to_clusters (length), 0))
+		return false;
+
+	memset (sector, 0, sizeof sector);
+	memcpy (sector, inode->data.inline_data, length);
+	inode->data.is_inline = false;
+	memset (inode->data.inline_data, 0, sizeof inode->data.inline_data);
+	if (length > 0)
+		page_cache_write (byte_to_sector (inode, 0), sector, 0, DISK_SECTOR_SIZE);
+	page_cache_write (inode->sector, &inode->data, 0, DISK_SECTOR_SIZE);
+	return true;
+}
+#endif
+
+/* Project 4. INLINE : inode 섹터 안에 저장된 작은 파일에 쓰기
+ * 데이터와 길이가 같은 섹터에 있으므로 섹터 I/O 한 번. 파일 끝 뒤의 inline_data는 항상 0 */
+static off_t
+inode_write_inline (struct inode *inode, const void *buffer, off_t size, off_t offset) {
+	off_t end = offset + size;
+
+	if (size <= 0)
+		return 0;
+#ifdef EFILESYS
+	ASSERT (end <= INODE_INLINE_MAX);
+	if (end > inode->data.length)
+		inode->data.length = end;
+#else
+	if (end > inode->data.length)
+		end = inode->data.length;
+	if (end <= offset)
+		return 0;
+#endif
+	memcpy (inode->data.inline_data + offset, buffer, end - offset);
+	page_cache_write (inode->sector, &inode->data, 0, DISK_SECTOR_SIZE);
+	return end - offset;
+}
+
 /* Returns the disk sector that contains byte offset POS within
  * INODE.
  * Returns -1 if INODE does not contain data for a byte at offset
  * POS. */
 static disk_sector_t
-byte_to_sector (const struct inode *inode, off_t pos) {
+byte_to_sector (struct inode *inode, off_t pos) {
 	ASSERT (inode != NULL);
+#ifdef EFILESYS
+	if (pos < inode->data.length) {
+		size_t sector_idx = pos / DISK_SECTOR_SIZE;
+		cluster_t clst = inode_cluster_at (inode, sector_idx / fat_sectors_per_cluster ());
+		if (clst != 0)
+			return cluster_to_sector (clst) + sector_idx % fat_sectors_per_cluster ();
+	}
+	return -1;
+#else
 	if (pos < inode->data.length)
 		return inode->data.start + pos / DISK_SECTOR_SIZE;
 	else
 		return -1;
+#endif
+}
+
+/* Project 4. IC : 메모리의 inode 해제 */
+static void
+inode_free (struct inode *inode) {
+#ifdef EFILESYS
+	free (inode->extents);
+#endif
+	free (inode);
+}
+
+/* Table of in-memory inodes keyed by sector, so that opening a
+ * single inode twice returns the same `struct inode'.
+ * Project 4. IC : 열린 inode와 최근에 닫힌 inode (closed_inodes)를 모두 담음 */
+static struct hash inode_table;
+
+/* Project 4. IC : open_cnt가 0인 inode를 닫힌 순서대로 (앞쪽이 가장 오래 됨) */
+static struct list closed_inodes;
+static size_t closed_cnt;
+
+static uint64_t
+inode_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct inode *inode = hash_entry (e, struct inode, elem);
+	return hash_int (inode->sector);
 }
 
-/* List of open inodes, so that opening a single inode twice
- * returns the same `struct inode'. */
-static struct list open_inodes;
+static bool
+inode_less (const struct hash_elem *a, const struct hash_elem *b, void *aux UNUSED) {
+	return hash_entry (a, struct inode, elem)->sector
+		< hash_entry (b, struct inode, elem)->sector;
+}
 
 /* Initializes the inode module. */
 void
 inode_init (void) {
-	list_init (&open_inodes);
+	hash_init (&inode_table, inode_hash, inode_less, NULL);
+	list_init (&closed_inodes);
+}
+
+/* Project 4. IC : 가장 오래 전에 닫힌 inode를 테이블에서 빼고 해제 */
+static void
+inode_evict_closed (void) {
+	struct inode *inode = list_entry (list_pop_front (&closed_inodes), struct inode, lru_elem);
+	closed_cnt--;
+	hash_delete (&inode_table, &inode->elem);
+	inode_free (inode);
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -80,17 +375,33 @@ inode_create (disk_sector_t sector, off_t length) {
 		size_t sectors = bytes_to_sectors (length);
 		disk_inode->length = length;
 		disk_inode->magic = INODE_MAGIC;
+
+		/* Project 4. INLINE : 작은 파일은 데이터 섹터 없이 inode 섹터에 저장 */
+		if (length <= INODE_INLINE_MAX) {
+			disk_inode->is_inline = true;
+			page_cache_write (sector, disk_inode, 0, DISK_SECTOR_SIZE);
+			free (disk_inode);
+			return true;
+		}
+#ifdef EFILESYS
+		disk_inode->cluster_cnt = DIV_ROUND_UP (sectors, fat_sectors_per_cluster ());
+		if (inode_allocate_chain (disk_inode->cluster_cnt, &disk_inode->start)) {
+			page_cache_write (sector, disk_inode, 0, DISK_SECTOR_SIZE);
+			success = true;
+		}
+#else
 		if (free_map_allocate (sectors, &disk_inode->start)) {
-			disk_write (filesys_disk, sector, disk_inode);
+			page_cache_write (sector, disk_inode, 0, DISK_SECTOR_SIZE);
 			if (sectors > 0) {
 				static char zeros[DISK_SECTOR_SIZE];
 				size_t i;
 
 				for (i = 0; i < sectors; i++) 
-					disk_write (filesys_disk, disk_inode->start + i, zeros); 
+					page_cache_write (disk_inode->start + i, zeros, 0, DISK_SECTOR_SIZE); 
 			}
 			success = true; 
 		} 
+#endif
 		free (disk_inode);
 	}
 	return success;
@@ -101,31 +412,43 @@ inode_create (disk_sector_t sector, off_t length) {
  * Returns a null pointer if memory allocation fails. */
 struct inode *
 inode_open (disk_sector_t sector) {
-	struct list_elem *e;
-	struct inode *inode;
-
-	/* Check whether this inode is already open. */
-	for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
-			e = list_next (e)) {
-		inode = list_entry (e, struct inode, elem);
-		if (inode->sector == sector) {
-			inode_reopen (inode);
-			return inode; 
+	struct hash_elem *e;
+	struct inode *inode, key;
+
+	/* Check whether this inode is already open.
+	 * Project 4. IC : 최근에 닫힌 inode라면 디스크를 읽지 않고 다시 사용 */
+	key.sector = sector;
+	e = hash_find (&inode_table, &key.elem);
+	if (e != NULL) {
+		inode = hash_entry (e, struct inode, elem);
+		if (inode->open_cnt == 0) {
+			list_remove (&inode->lru_elem);
+			closed_cnt--;
 		}
+		inode_reopen (inode);
+		return inode;
 	}
 
 	/* Allocate memory. */
 	inode = malloc (sizeof *inode);
+	if (inode == NULL && closed_cnt > 0) {			// Project 4. IC : 메모리가 부족하면 닫힌 inode부터 해제
+		inode_evict_closed ();
+		inode = malloc (sizeof *inode);
+	}
 	if (inode == NULL)
 		return NULL;
 
 	/* Initialize. */
-	list_push_front (&open_inodes, &inode->elem);
 	inode->sector = sector;
+	hash_insert (&inode_table, &inode->elem);
 	inode->open_cnt = 1;
 	inode->deny_write_cnt = 0;
 	inode->removed = false;
-	disk_read (filesys_disk, inode->sector, &inode->data);
+	page_cache_read (inode->sector, &inode->data, 0, DISK_SECTOR_SIZE);
+#ifdef EFILESYS
+	inode->extents = NULL;
+	inode->extent_cnt = inode->extent_cap = 0;
+#endif
 	return inode;
 }
 
@@ -154,17 +477,31 @@ inode_close (struct inode *inode) {
 
 	/* Release resources if this was the last opener. */
 	if (--inode->open_cnt == 0) {
-		/* Remove from inode list and release lock. */
-		list_remove (&inode->elem);
-
 		/* Deallocate blocks if removed. */
 		if (inode->removed) {
+			/* Remove from inode table. */
+			hash_delete (&inode_table, &inode->elem);
 			free_map_release (inode->sector, 1);
-			free_map_release (inode->data.start,
-					bytes_to_sectors (inode->data.length)); 
+#ifdef EFILESYS
+			if (inode->data.start != 0)
+				fat_remove_chain (inode->data.start, 0);
+#else
+			if (!inode->data.is_inline)
+				free_map_release (inode->data.start,
+						bytes_to_sectors (inode->data.length)); 
+#endif
+			inode_free (inode); 
+			return;
 		}
 
-		free (inode); 
+#ifdef EFILESYS
+		inode_trim (inode);
+#endif
+
+		/* Project 4. IC : 메타데이터를 유지한 채 LRU에 넣어 두고, 가득 차면 가장 오래된 것을 해제 */
+		list_push_back (&closed_inodes, &inode->lru_elem);
+		if (++closed_cnt > INODE_CACHE_SIZE)
+			inode_evict_closed ();
 	}
 }
 
@@ -183,7 +520,16 @@ off_t
 inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset) {
 	uint8_t *buffer = buffer_;
 	off_t bytes_read = 0;
-	uint8_t *bounce = NULL;
+
+	/* Project 4. INLINE : 데이터가 메모리의 inode에 있으므로 디스크 I/O 없음 */
+	if (inode->data.is_inline) {
+		if (size <= 0 || offset >= inode->data.length)
+			return 0;
+		if (size > inode->data.length - offset)
+			size = inode->data.length - offset;
+		memcpy (buffer, inode->data.inline_data + offset, size);
+		return size;
+	}
 
 	while (size > 0) {
 		/* Disk sector to read, starting byte offset within sector. */
@@ -200,31 +546,30 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset) {
 		if (chunk_size <= 0)
 			break;
 
-		if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE) {
-			/* Read full sector directly into caller's buffer. */
-			disk_read (filesys_disk, sector_idx, buffer + bytes_read); 
-		} else {
-			/* Read sector into bounce buffer, then partially copy
-			 * into caller's buffer. */
-			if (bounce == NULL) {
-				bounce = malloc (DISK_SECTOR_SIZE);
-				if (bounce == NULL)
-					break;
-			}
-			disk_read (filesys_disk, sector_idx, bounce);
-			memcpy (buffer + bytes_read, bounce + sector_ofs, chunk_size);
-		}
+		/* Project 4. BC : 버퍼 캐시에서 필요한 부분만 복사 */
+		page_cache_read (sector_idx, buffer + bytes_read, sector_ofs, chunk_size);
 
 		/* Advance. */
 		size -= chunk_size;
 		offset += chunk_size;
 		bytes_read += chunk_size;
 	}
-	free (bounce);
 
 	return bytes_read;
 }
 
+/* Project 4. RA : [OFFSET, OFFSET + SIZE) 범위의 섹터를 미리 읽도록 요청 (파일 끝까지만) */
+void
+inode_readahead (struct inode *inode, off_t size, off_t offset) {
+	off_t end = offset + size < inode_length (inode) ? offset + size : inode_length (inode);
+
+	if (inode->data.is_inline)					// Project 4. INLINE : 데이터 섹터 없음
+		return;
+
+	for (off_t pos = offset - offset % DISK_SECTOR_SIZE; pos < end; pos += DISK_SECTOR_SIZE)
+		page_cache_prefetch (byte_to_sector (inode, pos));
+}
+
 /* Writes SIZE bytes from BUFFER into INODE, starting at OFFSET.
  * Returns the number of bytes actually written, which may be
  * less than SIZE if end of file is reached or an error occurs.
@@ -235,11 +580,29 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 		off_t offset) {
 	const uint8_t *buffer = buffer_;
 	off_t bytes_written = 0;
-	uint8_t *bounce = NULL;
 
 	if (inode->deny_write_cnt)
 		return 0;
 
+	/* Project 4. INLINE : INODE_INLINE_MAX를 넘게 커지면 클러스터로 옮긴 뒤 일반 경로로 씀 */
+	if (inode->data.is_inline) {
+#ifdef EFILESYS
+		if (offset + size <= INODE_INLINE_MAX)
+			return inode_write_inline (inode, buffer_, size, offset);
+		if (!inode_uninline (inode))
+			return 0;
+#else
+		return inode_write_inline (inode, buffer_, size, offset);
+#endif
+	}
+
+#ifdef EFILESYS
+	/* Project 4. DALLOC : 파일 끝을 넘는 쓰기라면 먼저 파일을 늘림 (쓰기 전 빈 구간은 0) */
+	if (size > 0 && offset + size > inode->data.length
+			&& !inode_grow (inode, offset + size, offset))
+		return 0;
+#endif
+
 	while (size > 0) {
 		/* Sector to write, starting byte offset within sector. */
 		disk_sector_t sector_idx = byte_to_sector (inode, offset);
@@ -255,38 +618,69 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 		if (chunk_size <= 0)
 			break;
 
-		if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE) {
-			/* Write full sector directly to disk. */
-			disk_write (filesys_disk, sector_idx, buffer + bytes_written); 
-		} else {
-			/* We need a bounce buffer. */
-			if (bounce == NULL) {
-				bounce = malloc (DISK_SECTOR_SIZE);
-				if (bounce == NULL)
-					break;
-			}
-
-			/* If the sector contains data before or after the chunk
-			   we're writing, then we need to read in the sector
-			   first.  Otherwise we start with a sector of all zeros. */
-			if (sector_ofs > 0 || chunk_size < sector_left) 
-				disk_read (filesys_disk, sector_idx, bounce);
-			else
-				memset (bounce, 0, DISK_SECTOR_SIZE);
-			memcpy (bounce + sector_ofs, buffer + bytes_written, chunk_size);
-			disk_write (filesys_disk, sector_idx, bounce); 
-		}
+		/* Project 4. BC : 버퍼 캐시에 쓰고 디스크 기록은 나중에 (write-behind)
+		 * 섹터 일부만 쓰는 경우에만 캐시가 디스크에서 먼저 읽음 */
+		page_cache_write (sector_idx, buffer + bytes_written, sector_ofs, chunk_size);
 
 		/* Advance. */
 		size -= chunk_size;
 		offset += chunk_size;
 		bytes_written += chunk_size;
 	}
-	free (bounce);
 
 	return bytes_written;
 }
 
+/* Project 4. DALLOC : 파일 크기는 그대로 두고 LENGTH 바이트까지 쓸 공간을 미리 할당
+ * 예약한 공간은 닫을 때도 반환하지 않음. 공간이 부족하면 false */
+bool
+inode_reserve (struct inode *inode, off_t length) {
+	if (length < 0)
+		return false;
+#ifdef EFILESYS
+	if (inode->data.is_inline) {
+		if (length <= INODE_INLINE_MAX)
+			return true;
+		if (!inode_uninline (inode))
+			return false;
+	}
+
+	size_t cnt = bytes_to_clusters (length);
+	if (!inode_extend_chain (inode, cnt, 0))
+		return false;
+	if (cnt > inode->data.reserved_cnt)
+		inode->data.reserved_cnt = cnt;
+	page_cache_write (inode->sector, &inode->data, 0, DISK_SECTOR_SIZE);
+	return true;
+#else
+	/* 파일이 커질 수 없으므로 이미 할당된 범위만 가능 */
+	return length <= inode->data.length;
+#endif
+}
+
+/* Project 4. DALLOC : 파일 데이터가 디스크에서 몇 개의 연속 구간으로 나뉘어 있는지 리턴
+ * (inline이거나 빈 파일이면 0). 단편화 측정용 */
+size_t
+inode_extent_count (struct inode *inode) {
+#ifdef EFILESYS
+	if (inode->data.is_inline)
+		return 0;
+
+	size_t cnt = bytes_to_clusters (inode->data.length), runs = 0;
+	cluster_t prev = 0, clst = inode->data.start;
+	for (size_t i = 0; i < cnt && clst != 0 && clst != EOChain; i++) {
+		if (prev == 0 || clst != prev + 1)
+			runs++;
+		prev = clst;
+		clst = fat_get (clst);
+	}
+	return runs;
+#else
+	/* 파일은 항상 연속된 섹터에 있음 */
+	return inode->data.length > 0 ? 1 : 0;
+#endif
+}
+
 /* Disables writes to INODE.
    May be called at most once per inode opener. */
 	void
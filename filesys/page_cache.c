@@ -1,9 +1,20 @@
 /* page_cache.c: Implementation of Page Cache (Buffer Cache). */
 
 #include "vm/vm.h"
+#include "filesys/page_cache.h"
+#include <list.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "filesys/filesys.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
 static bool page_cache_readahead (struct page *page, void *kva);
 static bool page_cache_writeback (struct page *page);
 static void page_cache_destroy (struct page *page);
+static void page_cache_kworkerd (void *aux);
+static void page_cache_readaheadd (void *aux);
 
 /* DO NOT MODIFY this struct */
 static const struct page_operations page_cache_op = {
@@ -15,12 +26,221 @@ static const struct page_operations page_cache_op = {
 
 tid_t page_cache_workerd;
 
+/* Project 4. BC : 캐시된 섹터 하나 */
+struct cache_entry {
+	disk_sector_t sector;				// 캐시 중인 섹터 번호
+	bool valid;							// 사용 중인 엔트리인지 여부 (valid라면 해시 버킷에 있음)
+	bool dirty;							// 디스크에 아직 쓰지 않은 변경이 있는지 여부
+	bool accessed;						// clock 교체를 위한 접근 비트
+	bool loading;						// 디스크에서 읽는 중 (끝날 때까지 내용을 쓸 수 없음)
+	bool writing;						// 디스크에 쓰는 중 (끝날 때까지 교체할 수 없음)
+	int pin_cnt;						// 락 없이 내용을 복사 중인 스레드 수 (0보다 크면 교체할 수 없음)
+	struct list_elem hash_elem;			// 섹터 번호 해시 버킷 원소
+	uint8_t *data;						// 섹터 내용 (DISK_SECTOR_SIZE)
+};
+
+/* Project 4. BC : 캐시 엔트리 배열, 섹터 번호 해시, clock 위치. 모두 cache_lock으로 보호
+ * 디스크 I/O와 호출한 쪽 버퍼 (사용자 메모리일 수 있음)로의 복사는 락을 놓고 진행하며,
+ * 그 동안 엔트리는 loading, writing, pin_cnt로 보호. I/O나 복사가 끝나면 cache_cond로 알림 */
+static struct cache_entry cache[PAGE_CACHE_SIZE];
+static struct list cache_buckets[PAGE_CACHE_BUCKETS];
+static struct lock cache_lock;
+static struct condition cache_cond;
+static size_t cache_hand;
+
+/* Project 4. RA : readahead 요청 큐 (ra_lock으로 보호, ra_sema는 큐에 쌓인 요청 수) */
+static disk_sector_t ra_queue[RA_QUEUE_SIZE];
+static size_t ra_head, ra_cnt;
+static struct lock ra_lock;
+static struct semaphore ra_sema;
+
+/* Project 4. BC : 버퍼 캐시 초기화 후 write-behind 스레드 생성 (filesys_init에서 호출) */
+void
+page_cache_init (void) {
+	uint8_t *data = palloc_get_multiple (PAL_ASSERT,
+			PAGE_CACHE_SIZE * DISK_SECTOR_SIZE / PGSIZE);
+
+	lock_init (&cache_lock);
+	cond_init (&cache_cond);
+	for (size_t i = 0; i < PAGE_CACHE_BUCKETS; i++)
+		list_init (&cache_buckets[i]);
+	for (size_t i = 0; i < PAGE_CACHE_SIZE; i++)
+		cache[i].data = data + i * DISK_SECTOR_SIZE;
+	page_cache_workerd = thread_create ("kworkerd", PRI_DEFAULT, page_cache_kworkerd, NULL);
+
+	lock_init (&ra_lock);
+	sema_init (&ra_sema, 0);
+	thread_create ("readaheadd", PRI_DEFAULT, page_cache_readaheadd, NULL);
+}
+
 /* The initializer of file vm */
 void
 pagecache_init (void) {
 	/* TODO: Create a worker daemon for page cache with page_cache_kworkerd */
 }
 
+/* Project 4. BC : SECTOR를 캐시한 엔트리 검색 (없으면 NULL, cache_lock 필요) */
+static struct cache_entry *
+cache_find (disk_sector_t sector) {
+	struct list *bucket = &cache_buckets[sector % PAGE_CACHE_BUCKETS];
+	for (struct list_elem *e = list_begin (bucket); e != list_end (bucket); e = list_next (e)) {
+		struct cache_entry *ce = list_entry (e, struct cache_entry, hash_elem);
+		if (ce->sector == sector)
+			return ce;
+	}
+	return NULL;
+}
+
+/* Project 4. BC : dirty 엔트리 E를 디스크에 기록 (cache_lock 필요, I/O 동안 락을 놓음)
+ * 기록 중에 다시 쓰인 내용은 dirty가 다시 켜지므로 다음 flush 때 기록됨 */
+static void
+cache_writeback (struct cache_entry *e) {
+	e->writing = true;
+	e->dirty = false;
+	lock_release (&cache_lock);
+	disk_write (filesys_disk, e->sector, e->data);
+	lock_acquire (&cache_lock);
+	e->writing = false;
+	cond_broadcast (&cache_cond, &cache_lock);
+}
+
+/* Project 4. BC : clock으로 비울 엔트리를 골라 해시에서 빼고 리턴 (cache_lock 필요)
+ * dirty 엔트리를 write back 했거나 모든 엔트리가 사용 중이라 기다렸다면 락을 놓았던 것이므로
+ * NULL을 리턴해 호출한 쪽이 다시 검색하도록 함 */
+static struct cache_entry *
+cache_evict (void) {
+	for (size_t scanned = 0; scanned < 2 * PAGE_CACHE_SIZE; scanned++) {
+		struct cache_entry *e = &cache[cache_hand];
+		cache_hand = (cache_hand + 1) % PAGE_CACHE_SIZE;
+
+		if (!e->valid)
+			return e;
+		if (e->loading || e->writing || e->pin_cnt > 0)
+			continue;
+		if (e->accessed) {							// 최근에 접근했다면 한 번 더 기회
+			e->accessed = false;
+			continue;
+		}
+		if (e->dirty) {
+			cache_writeback (e);
+			return NULL;
+		}
+		list_remove (&e->hash_elem);
+		e->valid = false;
+		return e;
+	}
+
+	cond_wait (&cache_cond, &cache_lock);			// 모든 엔트리가 I/O나 복사 중
+	return NULL;
+}
+
+/* Project 4. BC : 비운 엔트리 E에 SECTOR를 등록하고, FILL이라면 디스크에서 읽음 (cache_lock 필요)
+ * 등록 후 읽는 동안에는 락을 놓고 loading으로 표시해 같은 섹터를 찾는 스레드만 기다리게 함 */
+static void
+cache_install (struct cache_entry *e, disk_sector_t sector, bool fill) {
+	ASSERT (!e->valid);
+
+	e->sector = sector;
+	e->valid = true;
+	e->dirty = false;
+	list_push_back (&cache_buckets[sector % PAGE_CACHE_BUCKETS], &e->hash_elem);
+	if (fill) {
+		e->loading = true;
+		lock_release (&cache_lock);
+		disk_read (filesys_disk, sector, e->data);
+		lock_acquire (&cache_lock);
+		e->loading = false;
+		cond_broadcast (&cache_cond, &cache_lock);
+	}
+}
+
+/* Project 4. BC : SECTOR의 엔트리를 리턴. 없으면 엔트리를 비워 캐시 (cache_lock 필요, I/O 동안 락을 놓음)
+ * 섹터 전체를 덮어쓸 예정이라면 (FILL이 false) 디스크에서 읽지 않음 */
+static struct cache_entry *
+cache_get (disk_sector_t sector, bool fill) {
+	for (;;) {
+		struct cache_entry *e = cache_find (sector);
+		if (e != NULL && e->loading) {				// 다른 스레드가 읽는 중이면 끝날 때까지 대기
+			cond_wait (&cache_cond, &cache_lock);
+			continue;
+		}
+		if (e == NULL && (e = cache_evict ()) == NULL)
+			continue;
+
+		if (!e->valid)
+			cache_install (e, sector, fill);
+		e->accessed = true;
+		return e;
+	}
+}
+
+/* Project 4. BC : SECTOR의 OFS부터 SIZE 바이트를 BUFFER로 읽기
+ * BUFFER는 사용자 메모리일 수 있고 복사 중 폴트가 다시 파일 시스템을 부를 수 있으므로
+ * 엔트리를 고정한 채 락을 놓고 복사 */
+void
+page_cache_read (disk_sector_t sector, void *buffer, int ofs, int size) {
+	ASSERT (ofs >= 0 && size >= 0 && ofs + size <= DISK_SECTOR_SIZE);
+
+	lock_acquire (&cache_lock);
+	struct cache_entry *e = cache_get (sector, true);
+	e->pin_cnt++;
+	lock_release (&cache_lock);
+
+	memcpy (buffer, e->data + ofs, size);
+
+	lock_acquire (&cache_lock);
+	if (--e->pin_cnt == 0)
+		cond_broadcast (&cache_cond, &cache_lock);
+	lock_release (&cache_lock);
+}
+
+/* Project 4. BC : BUFFER의 SIZE 바이트를 SECTOR의 OFS 위치에 쓰기
+ * 디스크에는 교체되거나 kworkerd가 flush할 때 기록
+ * 사용자 메모리는 폴트가 날 수 있으므로 락을 잡기 전에 커널 버퍼로 먼저 복사 */
+void
+page_cache_write (disk_sector_t sector, const void *buffer, int ofs, int size) {
+	uint8_t bounce[DISK_SECTOR_SIZE];
+
+	ASSERT (ofs >= 0 && size >= 0 && ofs + size <= DISK_SECTOR_SIZE);
+
+	if (is_user_vaddr (buffer)) {
+		memcpy (bounce, buffer, size);
+		buffer = bounce;
+	}
+
+	lock_acquire (&cache_lock);
+	struct cache_entry *e = cache_get (sector, size < DISK_SECTOR_SIZE);
+	memcpy (e->data + ofs, buffer, size);
+	e->dirty = true;
+	lock_release (&cache_lock);
+}
+
+/* Project 4. RA : SECTOR를 미리 읽도록 요청하고 바로 리턴 (실제 읽기는 readaheadd가 진행) */
+void
+page_cache_prefetch (disk_sector_t sector) {
+	lock_acquire (&ra_lock);
+	bool queued = ra_cnt < RA_QUEUE_SIZE;
+	if (queued)
+		ra_queue[(ra_head + ra_cnt++) % RA_QUEUE_SIZE] = sector;
+	lock_release (&ra_lock);
+
+	if (queued)
+		sema_up (&ra_sema);
+}
+
+/* Project 4. BC : 모든 dirty 섹터를 디스크에 기록 (kworkerd, filesys_done에서 호출)
+ * 섹터마다 락을 놓고 기록하므로 그 동안 다른 스레드의 캐시 접근이 막히지 않음 */
+void
+page_cache_flush (void) {
+	lock_acquire (&cache_lock);
+	for (size_t i = 0; i < PAGE_CACHE_SIZE; i++) {
+		struct cache_entry *e = &cache[i];
+		if (e->valid && e->dirty && !e->loading && !e->writing)
+			cache_writeback (e);
+	}
+	lock_release (&cache_lock);
+}
+
 /* Initialize the page cache */
 bool
 page_cache_initializer (struct page *page, enum vm_type type, void *kva) {
@@ -45,6 +265,38 @@ page_cache_destroy (struct page *page) {
 }
 
 /* Worker thread for page cache */
+/* Project 4. BC : 주기적으로 dirty 섹터를 write back (write-behind) */
+static void
+page_cache_kworkerd (void *aux UNUSED) {
+	for (;;) {
+		timer_sleep (PAGE_CACHE_FLUSH_INTERVAL);
+		page_cache_flush ();
+	}
+}
+
+/* Project 4. RA : 요청된 섹터를 캐시에 미리 읽어 둠
+ * 엔트리를 먼저 예약해 두고 락 없이 읽으므로, 다른 섹터에 대한 캐시 접근은 기다리지 않음
+ * 아직 사용되지 않은 섹터이므로 접근 비트는 꺼 둬서 먼저 교체되도록 함
+ * (읽는 동안 이 섹터를 기다린 스레드가 켠 접근 비트는 그대로 둠) */
 static void
-page_cache_kworkerd (void *aux) {
+page_cache_readaheadd (void *aux UNUSED) {
+	for (;;) {
+		sema_down (&ra_sema);
+
+		lock_acquire (&ra_lock);
+		disk_sector_t sector = ra_queue[ra_head];
+		ra_head = (ra_head + 1) % RA_QUEUE_SIZE;
+		ra_cnt--;
+		lock_release (&ra_lock);
+
+		lock_acquire (&cache_lock);
+		struct cache_entry *e = NULL;
+		while (cache_find (sector) == NULL && (e = cache_evict ()) == NULL)
+			continue;
+		if (e != NULL) {
+			e->accessed = false;
+			cache_install (e, sector, true);
+		}
+		lock_release (&cache_lock);
+	}
 }
@@ -11,6 +11,12 @@
  * retained, but much longer full path names must be allowed. */
 #define NAME_MAX 14
 
+/* Project 4. DIR : 루트 디렉터리의 엔트리 수 (디렉터리는 해시 테이블이므로 여유 있게) */
+#define ROOT_DIR_ENTRIES 512
+
+/* Project 4. DIR : 디렉터리 엔트리 캐시 크기 (direct-mapped) */
+#define DCACHE_SIZE 128
+
 struct inode;
 
 /* Opening and closing directories. */
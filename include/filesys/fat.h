@@ -14,10 +14,14 @@ typedef uint32_t cluster_t;  /* Index of a cluster within FAT. */
 #define EOChain 0x0FFFFFFF   /* End of cluster chain */
 
 /* Sectors of FAT information. */
-#define SECTORS_PER_CLUSTER 1 /* Number of sectors per cluster */
+#define SECTORS_PER_CLUSTER 1 /* Default number of sectors per cluster */
+#define SECTORS_PER_CLUSTER_MAX 64 /* Project 4. CLST : 설정 가능한 최대 클러스터 크기 */
 #define FAT_BOOT_SECTOR 0     /* FAT boot sector. */
 #define ROOT_DIR_CLUSTER 1    /* Cluster for the root directory */
 
+/* Project 4. CLST : 포맷할 때 사용할 클러스터 크기 (섹터, 커널 옵션 -spc=N 으로 변경 가능) */
+extern unsigned int fat_format_spc;
+
 void fat_init (void);
 void fat_open (void);
 void fat_close (void);
@@ -27,6 +31,7 @@ void fat_close (void);
 cluster_t fat_create_chain (
     cluster_t clst /* Cluster # to stretch, 0: Create a new chain */
 );
+cluster_t fat_create_chain_multiple (cluster_t clst, size_t cnt);
 void fat_remove_chain (
     cluster_t clst, /* Cluster # to be removed */
     cluster_t pclst /* Previous cluster of clst, 0: clst is the start of chain */
@@ -34,5 +39,7 @@ void fat_remove_chain (
 cluster_t fat_get (cluster_t clst);
 void fat_put (cluster_t clst, cluster_t val);
 disk_sector_t cluster_to_sector (cluster_t clst);
+cluster_t sector_to_cluster (disk_sector_t sector);
+unsigned int fat_sectors_per_cluster (void);
 
 #endif /* filesys/fat.h */
@@ -12,6 +12,11 @@ struct file {
 
 	/* Proj 2-7. Extra */
 	int dupCount; 				// 얼마나 많은 fd가 해당 파일을 공유하고 있는지 확인 (해당 값이 0일 때만 close 가능)
+
+	/* Project 4. RA : 순차 읽기 감지 */
+	off_t ra_next;				// 순차 읽기라면 다음 읽기가 시작될 위치
+	off_t ra_end;				// readahead를 요청해 둔 끝 위치
+	int ra_window;				// readahead 창 크기 (섹터, 0이면 readahead 안 함)
 };
 struct inode;
 
@@ -8,6 +8,9 @@
  * definition but not any others. */
 typedef int32_t off_t;
 
+/* Project 4. DALLOC : off_t의 최댓값 */
+#define OFF_T_MAX INT32_MAX
+
 /* Format specifier for printf(), e.g.:
  * printf ("offset=%"PROTd"\n", offset); */
 #define PROTd PRId32
@@ -1,12 +1,27 @@
 #ifndef FILESYS_PAGE_CACHE_H
 #define FILESYS_PAGE_CACHE_H
-#include "vm/vm.h"
+#include <stdbool.h>
+#include "devices/disk.h"
 
 struct page;
 enum vm_type;
 
 struct page_cache {};
 
+/* Project 4. BC : 파일 시스템 디스크 섹터 버퍼 캐시 (clock 교체, write-behind) */
+#define PAGE_CACHE_SIZE 256				// 캐시하는 섹터 수 (readahead 창 최대 크기보다 충분히 크게)
+#define PAGE_CACHE_FLUSH_INTERVAL 500	// dirty 섹터 write back 주기 (tick)
+#define PAGE_CACHE_BUCKETS 64			// 섹터 번호로 엔트리를 찾기 위한 해시 버킷 수
+
+/* Project 4. RA : 순차 읽기에 대한 비동기 readahead */
+#define RA_MIN_WINDOW 4					// 순차 읽기를 처음 감지했을 때 창 크기 (섹터)
+#define RA_MAX_WINDOW 64				// 창 최대 크기 (섹터)
+#define RA_QUEUE_SIZE 128				// readahead 요청 큐 크기 (가득 차면 요청을 버림)
+
 void page_cache_init (void);
 bool page_cache_initializer (struct page *page, enum vm_type type, void *kva);
+void page_cache_read (disk_sector_t sector, void *buffer, int ofs, int size);
+void page_cache_write (disk_sector_t sector, const void *buffer, int ofs, int size);
+void page_cache_flush (void);
+void page_cache_prefetch (disk_sector_t sector);
 #endif
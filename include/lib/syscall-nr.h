@@ -1,6 +1,8 @@
 #ifndef __LIB_SYSCALL_NR_H
 #define __LIB_SYSCALL_NR_H
 
+#include <stddef.h>
+
 /* System call numbers. */
 enum {
 	/* Projects 2 and later. */
@@ -36,6 +38,36 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Project 3. Extra */
+	SYS_MADVISE,                /* Advise about use of memory. */
+	SYS_MSYNC,                  /* Write back a memory mapping. */
+	SYS_SBRK,                   /* Grow or shrink the heap. */
+	SYS_SPAWN,                  /* Start a new process from an executable. */
+	SYS_MEMSTAT,                /* Report the process's memory usage. */
+	SYS_SET_RSS_LIMIT,          /* Limit the process's resident pages. */
+
+	/* Project 4. Extra */
+	SYS_FALLOCATE,              /* Reserve disk space for a file. */
+};
+
+/* Advice values for madvise(). */
+#define MADV_NORMAL 0           /* No special treatment. */
+#define MADV_RANDOM 1           /* Expect random page references. */
+#define MADV_SEQUENTIAL 2       /* Expect sequential page references. */
+#define MADV_WILLNEED 3         /* Will need these pages soon. */
+#define MADV_DONTNEED 4         /* Don't need these pages any more. */
+
+/* Flags for mmap(), OR'd into the WRITABLE argument. */
+#define MAP_ANONYMOUS 0x20      /* Zero-filled memory not backed by a file (fd -1). */
+#define MAP_POPULATE 0x8000     /* Load every page of the mapping up front. */
+
+/* Memory usage of a process, in pages, as reported by memstat(). */
+struct memstat {
+	size_t resident;            /* Pages backed by a frame. */
+	size_t swapped;             /* Anonymous pages in swap. */
+	size_t working_set;         /* Estimated working-set size. */
+	size_t rss_limit;           /* Resident page limit (0 if none). */
 };
 
 #endif /* lib/syscall-nr.h */
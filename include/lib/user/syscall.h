@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <syscall-nr.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -25,6 +27,7 @@ void halt (void) NO_RETURN;
 void exit (int status) NO_RETURN;
 pid_t fork (const char *thread_name);
 int exec (const char *file);
+pid_t spawn (const char *file);
 int wait (pid_t);
 bool create (const char *file, unsigned initial_size);
 bool remove (const char *file);
@@ -41,6 +44,11 @@ int dup2(int oldfd, int newfd);
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
+int madvise (void *addr, size_t length, int advice);
+int msync (void *addr, size_t length);
+void *sbrk (intptr_t increment);
+int memstat (struct memstat *);
+int set_rss_limit (size_t pages);
 
 /* Project 4 only. */
 bool chdir (const char *dir);
@@ -49,6 +57,7 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 int symlink (const char* target, const char* linkpath);
+int fallocate (int fd, off_t offset, off_t length);
 
 static inline void* get_phys_addr (void *user_addr) {
 	void* pa;
@@ -78,4 +87,32 @@ get_fs_disk_write_cnt (void) {
 	return write_cnt;
 }
 
+/* Project 3. KSM : 같은 내용의 페이지 병합으로 아낀 프레임 수 */
+static inline long long
+get_ksm_pages_sharing (void) {
+	long long sharing;
+	asm volatile ("int $0x45");
+	asm volatile ("\t movq %%rax, %0": "=r" (sharing));
+	return sharing;
+}
+
+/* Project 3. SPT : 현재 프로세스의 페이지 정보가 차지하는 커널 메모리 (바이트) */
+static inline long long
+get_spt_bytes (void) {
+	long long bytes;
+	asm volatile ("int $0x46");
+	asm volatile ("\t movq %%rax, %0": "=r" (bytes));
+	return bytes;
+}
+
+/* Project 4. DALLOC : FD 파일의 데이터가 디스크에서 나뉜 연속 구간 수 */
+static inline long long
+get_file_extents (int fd) {
+	long long extents;
+	asm volatile ("movq %0, %%rax" ::"r"((long long) fd));
+	asm volatile ("int $0x47");
+	asm volatile ("\t movq %%rax, %0": "=r" (extents));
+	return extents;
+}
+
 #endif /* lib/user/syscall.h */
@@ -132,6 +132,7 @@ struct thread {
 	struct list child_list; 			// 노트. 자신에게 fork 된 child 프로세스들의 리스트
 	struct list_elem child_elem; 			// 노트. child 프로세스 리스트를 관리하기 위해 별도로 구분한 element
 	struct semaphore fork_sema; 		// 노트. child fork가 __do_fork, 즉 fork를 완료할 때까지 기다리기 위한 sema
+	bool load_success;					// Project 3. SPAWN : spawn 된 자식의 로드 성공 여부 (fork_sema를 올리기 전에 설정)
 
 	/* Proj 2-3. wait syscall */
 	struct semaphore wait_sema;			// 노트. child 프로세스를 기다리기 위해 사용
@@ -166,6 +167,14 @@ struct thread {
 	 * from user to kernel mode. */
 	uintptr_t saving_rsp;
 
+	/* Project 3. RSS : 프로세스별 메모리 사용량 */
+	size_t rss;							// 프레임을 가진 페이지 수
+	size_t swapped;						// 스왑 (압축 캐시 포함) 된 어나니머스 페이지 수
+	size_t rss_limit;					// 상주 페이지 수 상한 (0이면 제한 없음)
+	size_t wss;							// 접근 비트 샘플링으로 추정한 working set 크기
+	size_t ws_accessed;					// 이번 샘플링 구간에 접근된 페이지 수
+	bool oom_killed;					// Project 3. OOM : 메모리 부족으로 종료할 프로세스로 선택됨
+
 #endif
 
 	/* Owned by thread.c. */
@@ -200,6 +209,10 @@ const char *thread_name (void);
 void thread_exit (void) NO_RETURN;
 void thread_yield (void);
 
+/* Performs some operation on thread t, given auxiliary data AUX. */
+typedef void thread_action_func (struct thread *t, void *aux);
+void thread_foreach (thread_action_func *, void *);
+
 int thread_get_priority (void);
 void thread_set_priority (int);
 
@@ -15,9 +15,21 @@ struct anon_page {
     /* Project 3. Swap In/Out : 어나니머스 페이지에 스왑 정보 입력을 위한 멤버 추가 */
     size_t swap_slot_idx;
 
+    /* Project 3. ZSWAP : 압축 메모리 캐시에 저장된 경우의 엔트리 정보 */
+    struct zswap_entry *zswap;
+
+    /* Project 3. KSM : 같은 내용의 페이지 병합을 위한 정보 */
+    struct ksm_frame *ksm;          // 병합된 프레임 (병합되지 않았으면 NULL)
+    uint32_t ksm_checksum;          // 지난 스캔 때의 내용 체크섬 (Project 3. SPT : struct page 크기를 줄이기 위해 32비트)
+    bool ksm_unstable;              // 병합 후보 테이블에 있는지 여부
+    struct list_elem ksm_elem;      // 병합 후보 테이블 또는 병합 프레임의 sharers를 위한 elem
+
 };
 
 void vm_anon_init (void);
 bool anon_initializer (struct page *page, enum vm_type type, void *kva);
 
+/* Project 3. ZSWAP : 압축 캐시에서 write back 할 때 사용 */
+bool anon_swap_to_disk (struct page *page, const void *kva);
+
 #endif
\ No newline at end of file
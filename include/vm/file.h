@@ -13,18 +13,21 @@ struct file_page {
 	off_t size;				// real written size except zero bytes
 	off_t ofs;				// 시작되는 위치
 
+	/* Project 3. MSYNC : 주기적 write back을 위한 정보 */
+	struct thread *owner;			// 페이지를 매핑한 프로세스 (dirty 비트 확인용)
+	struct list_elem flush_elem;	// 메모리에 올라와 있는 파일 페이지 리스트를 위한 elem
+	bool resident;					// flush_elem이 리스트에 들어 있는지 여부
 };
 
-/* Project 3. MMF : do_mmap 함수를 위해 mmap_info 구조체 생성*/
-struct mmap_info{
-	struct file* file;		// 파일 정보
-	off_t offset;			// 오프셋 정보
-	size_t read_bytes;		// 저장 길이
-};
+/* Project 3. MSYNC : dirty 파일 페이지를 주기적으로 write back 하는 flusher 설정 */
+#define FLUSH_INTERVAL 500		// write back 주기 (tick)
+#define FLUSH_BATCH 64			// 한 번에 모아서 정렬하는 페이지 수
+#define FLUSH_RUN_MAX 8			// 한 번의 write로 합치는 최대 페이지 수
 
 void vm_file_init (void);
 bool file_backed_initializer (struct page *page, enum vm_type type, void *kva);
 void *do_mmap(void *addr, size_t length, int writable,
 		struct file *file, off_t offset);
 void do_munmap (void *va);
+void do_msync (void *addr, size_t length);
 #endif
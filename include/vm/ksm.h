@@ -0,0 +1,25 @@
+#ifndef VM_KSM_H
+#define VM_KSM_H
+#include <stdint.h>
+#include <list.h>
+#include "vm/vm.h"
+
+/* Project 3. KSM : 내용이 같은 어나니머스 프레임을 하나의 읽기 전용 프레임으로 병합 */
+
+#define KSM_SCAN_INTERVAL 100		// 스캔 주기 (tick)
+#define KSM_PAGES_PER_SCAN 64		// 한 주기에 확인하는 프레임 수
+#define KSM_BUCKETS 64				// 체크섬 테이블 버킷 수
+
+/* 여러 페이지가 병합되어 공유 중인 읽기 전용 프레임 */
+struct ksm_frame {
+	uint32_t checksum;				// 프레임 내용의 체크섬
+	struct frame frame;				// 공유 프레임 (frame_list에 넣지 않으므로 축출 대상이 아님)
+	struct list sharers;			// 이 프레임을 매핑 중인 anon_page 리스트
+	struct list_elem bucket_elem;	// 체크섬 테이블을 위한 elem
+};
+
+void ksm_init (void);
+void ksm_unmerge (struct page *page);
+void ksm_forget (struct page *page);
+
+#endif /* vm/ksm.h */
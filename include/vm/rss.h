@@ -0,0 +1,29 @@
+#ifndef VM_RSS_H
+#define VM_RSS_H
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Project 3. RSS : 프로세스별 상주 페이지 수 관리와 접근 비트 샘플링을 통한 working set 추정
+ * 한 프로세스의 폴트 폭주가 전역 clock을 통해 다른 프로세스의 working set을 밀어내지 않도록 함 */
+
+#define RSS_SAMPLE_INTERVAL 100		// 접근 비트 샘플링 주기 (tick)
+#define RSS_LIMIT_MIN 16			// 설정 가능한 최소 상한 (페이지)
+#define RSS_SCAN_AHEAD 16			// 상한이나 working set을 넘은 프로세스의 프레임을 찾아 더 살펴보는 프레임 수
+#define RSS_WS_SLACK 16				// 추정한 working set보다 이만큼 넘게 상주해야 축출 우선 대상으로 봄
+
+/* Project 3. OOM : 스왑까지 가득 차 프레임을 구할 수 없을 때 상주 + 스왑 페이지가 가장 많은 프로세스를 종료 */
+#define EVICT_RETRY 8				// 스왑 아웃에 실패했을 때 다른 victim으로 다시 시도하는 횟수
+#define OOM_WAIT_TICKS 100			// 다른 프로세스를 종료시킨 뒤 메모리가 풀리기를 기다리는 최대 시간 (tick)
+
+struct thread;
+
+extern size_t vm_rss_default_limit;
+
+void vm_rss_init (void);
+void vm_rss_adjust (struct thread *t, int resident, int swapped);
+int vm_rss_pressure (struct thread *t);
+bool vm_rss_set_limit (size_t pages);
+bool vm_oom_kill (void);
+void vm_oom_check (void);
+
+#endif /* vm/rss.h */
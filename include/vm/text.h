@@ -0,0 +1,43 @@
+#ifndef VM_TEXT_H
+#define VM_TEXT_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <list.h>
+#include <hash.h>
+#include "filesys/off_t.h"
+
+/* Project 3. ST : 같은 실행 파일의 읽기 전용 세그먼트 (text) 페이지를 프로세스 간에 공유 */
+
+struct page;
+struct frame;
+struct file;
+struct inode;
+struct thread;
+enum vm_type;
+
+/* 여러 프로세스가 함께 매핑하고 있는 text 프레임 하나에 대한 정보
+ * (INODE, OFS, READ_BYTES)가 같은 페이지들이 하나의 프레임을 공유 */
+struct text_frame {
+	struct inode *inode;		// 페이지 내용을 가진 실행 파일의 inode
+	off_t ofs;					// 파일 내 위치
+	size_t read_bytes;			// 파일에서 읽은 바이트 수 (나머지는 0)
+	struct frame *frame;		// 공유 중인 프레임
+	struct list sharers;		// 이 프레임을 매핑 중인 text_page 리스트
+	struct hash_elem hash_elem;	// text_table을 위한 elem
+};
+
+/* text 페이지 정보 (struct page의 union 멤버)
+ * Project 3. SPT : 다시 읽어올 파일은 page->vma->file (세그먼트 영역이 소유) */
+struct text_page {
+	struct thread *owner;			// 페이지를 가진 프로세스 (eviction 시 매핑 해제에 사용)
+	off_t ofs;						// 파일 내 위치
+	size_t read_bytes;				// 파일에서 읽을 바이트 수
+	struct text_frame *tf;			// 공유 프레임 (공유하지 않는 프레임이거나 프레임이 없으면 NULL)
+	struct list_elem sharer_elem;	// text_frame의 sharers를 위한 elem
+};
+
+void vm_text_init (void);
+bool text_initializer (struct page *page, enum vm_type type, void *kva);
+bool text_attach (struct page *page);
+
+#endif /* vm/text.h */
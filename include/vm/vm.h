@@ -22,6 +22,7 @@ enum vm_type {
 	 * markers, until the value is fit in the int. */
 	VM_MARKER_0 = (1 << 3),
 	VM_MARKER_1 = (1 << 4),
+	VM_MARKER_2 = (1 << 5),		// Project 3. ST : 공유 text 페이지 표시용 마커 추가
 
 	/* DO NOT EXCEED THIS VALUE. */
 	VM_MARKER_END = (1 << 31),
@@ -30,6 +31,8 @@ enum vm_type {
 #include "vm/uninit.h"
 #include "vm/anon.h"
 #include "vm/file.h"
+#include "vm/text.h"
+#include "vm/vma.h"
 #ifdef EFILESYS
 #include "filesys/page_cache.h"
 #endif
@@ -39,6 +42,14 @@ struct thread;
 
 #define VM_TYPE(type) ((type) & 7)
 
+/* Project 3. ZP : 내용이 전부 0으로 시작하는 어나니머스 페이지 표시 (BSS, 스택)
+ * 읽기 폴트 시에는 공유 zero page를 읽기 전용으로 매핑하고 첫 쓰기 때 프레임을 할당 */
+#define VM_ZERO_FILL VM_MARKER_1
+
+/* Project 3. ST : 실행 파일의 읽기 전용 세그먼트 페이지 표시
+ * 같은 실행 파일을 실행 중인 프로세스끼리 프레임을 공유 */
+#define VM_SHARED_TEXT VM_MARKER_2
+
 /* The representation of "page".
  * This is kind of "parent class", which has four "child class"es, which are
  * uninit_page, file_page, anon_page, and page cache (project4).
@@ -53,12 +64,17 @@ struct page {
 	struct hash_elem hash_elem;			// page_table을 해시테이블로 구현함에 따라 hash_elem 추가
 	bool writable;						// page의 쓰기 가능 여부를 체크하는 구분자 추가
 
+	/* Project 3. MR : 페이지를 만든 영역 (VMA 밖의 페이지면 NULL) */
+	struct vma *vma;
+	struct list_elem vma_elem;			// vma->pages를 위한 elem
+
 	/* Per-type data are binded into the union.
 	 * Each function automatically detects the current union */
 	union {
 		struct uninit_page uninit;
 		struct anon_page anon;
 		struct file_page file;
+		struct text_page text;		// Project 3. ST : 공유 text 페이지
 #ifdef EFILESYS
 		struct page_cache page_cache;
 #endif
@@ -96,8 +112,16 @@ struct page_operations {
  * All designs up to you for this. */
 struct supplemental_page_table {
 	struct hash* page_table;		// Project 3. MM : hash 추가
+	struct vma_tree vmas;			// Project 3. VMA : 실행 파일 세그먼트, mmap 영역
+
+	/* Project 3. HEAP : sbrk로 늘리고 줄이는 힙 [heap_start, brk) */
+	void *heap_start;				// 실행 파일 세그먼트 바로 뒤 (page-aligned)
+	void *brk;						// 현재 힙의 끝
 };
 
+/* Project 3. VMA : 스택이 자랄 수 있는 최대 크기 (이 영역에는 mmap 불가) */
+#define STACK_LIMIT (1 << 20)
+
 #include "threads/thread.h"
 void supplemental_page_table_init (struct supplemental_page_table *spt);
 bool supplemental_page_table_copy (struct supplemental_page_table *dst,
@@ -120,11 +144,34 @@ void vm_dealloc_page (struct page *page);
 bool vm_claim_page (void *va);
 enum vm_type page_get_type (struct page *page);
 
-struct load_info {
-	struct file *file;
-	off_t ofs;
-	size_t page_read_bytes;
-	size_t page_zero_bytes;
-};
+/* Project 3. ZP : 공유 zero page 관련 함수 */
+bool vm_is_zero_mapped (struct page *page);
+
+/* Project 3. KSM : 병합 스캐너와 페이지 삭제가 frame_list를 다루기 위한 함수 */
+void vm_frame_lock (void);
+void vm_frame_unlock (void);
+struct frame *vm_frame_scan_next (void);
+void vm_frame_unlink (struct frame *frame);
+void vm_frame_remove (struct frame *frame);
+
+/* Project 3. RSS : 프로세스별 사용량 집계를 위한 함수 */
+void vm_frame_foreach (void (*func) (struct frame *, void *), void *aux);
+struct thread *vm_page_owner (struct page *page);
+
+/* Project 3. MADV : madvise 시스템 콜 처리 */
+void vm_madvise (void *addr, size_t length, int advice);
+
+/* Project 3. POPULATE : mmap 시 영역 전체를 미리 로드 */
+void vm_populate (void *addr, size_t length);
+
+/* Project 3. HEAP : sbrk 시스템 콜 처리 */
+void *vm_sbrk (intptr_t increment);
+
+/* Project 3. FA : fault-around 설정 (한 번의 폴트로 채울 수 있는 최대 페이지 수) */
+#define FAULT_AROUND_DEFAULT 8
+#define FAULT_AROUND_MAX 32
+extern size_t vm_fault_around_pages;
+size_t vm_collect_fault_around (struct page *page, vm_initializer *init,
+		struct page **pages, size_t max);
 
 #endif  /* VM_VM_H */
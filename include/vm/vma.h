@@ -0,0 +1,53 @@
+#ifndef VM_VMA_H
+#define VM_VMA_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <list.h>
+#include <syscall-nr.h>
+#include "filesys/off_t.h"
+
+/* Project 3. VMA : 실행 파일 세그먼트와 mmap 영역을 페이지 단위가 아닌 범위 단위로 관리
+ * struct page는 해당 주소에서 폴트가 발생했을 때 만들어 짐 */
+
+struct vma;
+struct file;
+
+/* VMA 종류별 동작 */
+struct vma_operations {
+	bool (*materialize) (struct vma *vma, void *upage);	// UPAGE에 해당하는 페이지를 SPT에 생성
+	bool inherit;										// fork 시 자식에게 복사하는지 여부
+};
+
+/* 가상 메모리 영역 하나 [start, end) */
+struct vma {
+	void *start;						// 시작 주소 (page-aligned)
+	void *end;							// 끝 주소 (page-aligned, 포함하지 않음)
+	struct file *file;					// 영역의 내용을 가진 파일 (VMA가 소유, 어나니머스 영역은 NULL)
+	off_t ofs;							// start에 해당하는 파일 내 위치
+	size_t file_bytes;					// start부터 파일에서 읽을 바이트 수 (나머지는 0)
+	bool writable;						// 쓰기 가능 여부
+	const struct vma_operations *ops;
+	struct list pages;					// Project 3. MR : 폴트로 만들어진 페이지 리스트 (page->vma_elem)
+	int advice;							// Project 3. MADV : 접근 패턴 (MADV_NORMAL, MADV_RANDOM, MADV_SEQUENTIAL)
+
+	/* 시작 주소 기준 AVL 트리 */
+	struct vma *left, *right;
+	int height;
+};
+
+/* 프로세스 하나의 VMA 집합 */
+struct vma_tree {
+	struct vma *root;
+	size_t cnt;
+};
+
+void vma_tree_init (struct vma_tree *tree);
+bool vma_insert (struct vma_tree *tree, struct vma *vma);
+void vma_remove (struct vma_tree *tree, struct vma *vma);
+struct vma *vma_find (struct vma_tree *tree, const void *va);
+bool vma_overlaps (struct vma_tree *tree, const void *start, const void *end);
+size_t vma_file_bytes_at (const struct vma *vma, const void *upage);
+bool vma_tree_copy (struct vma_tree *dst, struct vma_tree *src);
+void vma_tree_destroy (struct vma_tree *tree);
+
+#endif /* vm/vma.h */
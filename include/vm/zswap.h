@@ -0,0 +1,28 @@
+#ifndef VM_ZSWAP_H
+#define VM_ZSWAP_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <list.h>
+
+/* Project 3. ZSWAP : 스왑 디스크 앞단에 두는 압축 메모리 캐시 */
+
+/* 압축 풀(pool)이 사용할 수 있는 최대 바이트 수. 넘치면 LRU 순서로 스왑 디스크에 write back */
+#define ZSWAP_POOL_MAX (256 * 1024)
+
+struct page;
+
+/* 압축된 페이지 하나에 대한 정보 */
+struct zswap_entry {
+	struct page *page;			// 해당 엔트리를 소유한 어나니머스 페이지
+	size_t len;					// 압축된 길이 (0이면 전부 0으로 채워진 페이지)
+	uint8_t *data;				// 압축된 데이터 (zero page인 경우 NULL)
+	struct list_elem lru_elem;	// LRU 리스트를 위한 elem
+};
+
+void zswap_init (void);
+bool zswap_store (struct page *page, const void *kva);
+bool zswap_load (struct page *page, void *kva);
+bool zswap_invalidate (struct page *page);
+
+#endif /* vm/zswap.h */
@@ -0,0 +1,255 @@
+#include <malloc.h>
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+
+/* A size-class implementation of malloc() for user programs.
+
+   Requests of up to SMALL_MAX bytes are rounded up to a power of
+   2 and served from the free list of that size class.  Each list
+   is a plain LIFO stack of blocks, so malloc() and free() of
+   small blocks are a push or a pop with no searching, in the
+   style of a per-thread cache.  (User processes have a single
+   thread, so no locking is needed.)  When a class runs dry, a
+   whole span of SPAN_SIZE bytes is taken from the heap with
+   sbrk() and carved into blocks of that class at once.
+
+   Larger requests get a block of exactly the requested size,
+   rounded to ALIGN.  Freed large blocks are kept in a list
+   sorted by address and merged with their neighbors, and are
+   reused first-fit.  A free block that ends at the top of the
+   heap and is at least TRIM_SIZE bytes is given back to the
+   kernel with a negative sbrk().
+
+   Every block starts with a header that records its size class
+   and usable size. */
+
+#define ALIGN 16                        /* Alignment of every block. */
+#define MIN_SHIFT 4                     /* Smallest class is 16 bytes. */
+#define CLASS_CNT 8                     /* Classes of 16 ... 2048 bytes. */
+#define SMALL_MAX (1 << (MIN_SHIFT + CLASS_CNT - 1))
+#define LARGE CLASS_CNT                 /* Class of a large block. */
+#define SPAN_SIZE (16 * 1024)           /* Heap taken per class refill. */
+#define TRIM_SIZE (64 * 1024)           /* Free top block size to trim. */
+
+/* Block header. */
+struct header {
+	size_t size;                        /* Usable bytes after header. */
+	size_t class;                       /* Size class, or LARGE. */
+};
+
+/* Free small block. */
+struct free_block {
+	struct header hdr;
+	struct free_block *next;            /* Next block of the same class. */
+};
+
+/* Free large block. */
+struct large_block {
+	struct header hdr;
+	struct large_block *next;           /* Next free block by address. */
+};
+
+static struct free_block *free_lists[CLASS_CNT];
+static struct large_block *large_free;
+
+/* Returns the block header of payload P. */
+static struct header *
+header_of (void *p) {
+	return (struct header *) p - 1;
+}
+
+/* Returns the first byte past large block B. */
+static uint8_t *
+large_end (struct large_block *b) {
+	return (uint8_t *) (&b->hdr + 1) + b->hdr.size;
+}
+
+/* Extends the heap by SIZE bytes, keeping the new memory
+   aligned to ALIGN.  Returns a null pointer on failure. */
+static void *
+heap_grow (size_t size) {
+	uintptr_t brk = (uintptr_t) sbrk (0);
+	size_t pad = ROUND_UP (brk, ALIGN) - brk;
+	uint8_t *p = sbrk (pad + size);
+
+	return p != (void *) -1 ? p + pad : NULL;
+}
+
+/* Returns the size class that holds SIZE bytes. */
+static size_t
+class_of (size_t size) {
+	size_t class = 0;
+	while (((size_t) 1 << (MIN_SHIFT + class)) < size)
+		class++;
+	return class;
+}
+
+/* Carves a new span into blocks of CLASS.  Returns false if the
+   heap cannot grow. */
+static bool
+refill (size_t class) {
+	size_t block_size = sizeof (struct header) + ((size_t) 1 << (MIN_SHIFT + class));
+	uint8_t *span = heap_grow (SPAN_SIZE);
+	if (span == NULL)
+		return false;
+
+	for (size_t ofs = 0; ofs + block_size <= SPAN_SIZE; ofs += block_size) {
+		struct free_block *b = (struct free_block *) (span + ofs);
+		b->hdr.size = (size_t) 1 << (MIN_SHIFT + class);
+		b->hdr.class = class;
+		b->next = free_lists[class];
+		free_lists[class] = b;
+	}
+	return true;
+}
+
+/* Allocates a large block of SIZE bytes. */
+static void *
+large_malloc (size_t size) {
+	size = ROUND_UP (size, ALIGN);
+
+	/* First fit, splitting off the tail if it is big enough to
+	   be a large block of its own. */
+	for (struct large_block **bp = &large_free; *bp != NULL; bp = &(*bp)->next) {
+		struct large_block *b = *bp;
+		if (b->hdr.size < size)
+			continue;
+
+		if (b->hdr.size >= size + sizeof (struct header) + SMALL_MAX) {
+			struct large_block *rest = (struct large_block *) ((uint8_t *) (&b->hdr + 1) + size);
+			rest->hdr.size = b->hdr.size - size - sizeof (struct header);
+			rest->hdr.class = LARGE;
+			rest->next = b->next;
+			*bp = rest;
+			b->hdr.size = size;
+		} else
+			*bp = b->next;
+		return &b->hdr + 1;
+	}
+
+	struct header *h = heap_grow (sizeof *h + size);
+	if (h == NULL)
+		return NULL;
+	h->size = size;
+	h->class = LARGE;
+	return h + 1;
+}
+
+/* Frees large block B, merging it with free neighbors and
+   returning it to the kernel if it ends up at the heap top. */
+static void
+large_free_block (struct large_block *b) {
+	struct large_block *pprev = NULL, *prev = NULL, *next = large_free;
+	while (next != NULL && next < b) {
+		pprev = prev;
+		prev = next;
+		next = next->next;
+	}
+
+	b->next = next;
+	if (prev != NULL)
+		prev->next = b;
+	else
+		large_free = b;
+
+	if (next != NULL && large_end (b) == (uint8_t *) next) {
+		b->hdr.size += sizeof (struct header) + next->hdr.size;
+		b->next = next->next;
+	}
+	if (prev != NULL && large_end (prev) == (uint8_t *) b) {
+		prev->hdr.size += sizeof (struct header) + b->hdr.size;
+		prev->next = b->next;
+		b = prev;
+		prev = pprev;
+	}
+
+	if (b->next == NULL && b->hdr.size >= TRIM_SIZE
+			&& large_end (b) == (uint8_t *) sbrk (0)) {
+		if (prev != NULL)
+			prev->next = NULL;
+		else
+			large_free = NULL;
+		sbrk (-(large_end (b) - (uint8_t *) b));
+	}
+}
+
+/* Obtains and returns a new block of at least SIZE bytes.
+   Returns a null pointer if memory is not available. */
+void *
+malloc (size_t size) {
+	if (size == 0)
+		return NULL;
+	if (size > SMALL_MAX)
+		return large_malloc (size);
+
+	size_t class = class_of (size);
+	if (free_lists[class] == NULL && !refill (class))
+		return NULL;
+
+	struct free_block *b = free_lists[class];
+	free_lists[class] = b->next;
+	return &b->hdr + 1;
+}
+
+/* Allocates and return A times B bytes initialized to zeroes.
+   Returns a null pointer if memory is not available. */
+void *
+calloc (size_t a, size_t b) {
+	size_t size = a * b;
+	if (b != 0 && size / b != a)
+		return NULL;
+
+	void *p = malloc (size);
+	if (p != NULL)
+		memset (p, 0, size);
+	return p;
+}
+
+/* Attempts to resize OLD_BLOCK to NEW_SIZE bytes, possibly
+   moving it in the process.
+   If successful, returns the new block; on failure, returns a
+   null pointer.
+   A call with null OLD_BLOCK is equivalent to malloc(NEW_SIZE).
+   A call with zero NEW_SIZE is equivalent to free(OLD_BLOCK). */
+void *
+realloc (void *old_block, size_t new_size) {
+	if (new_size == 0) {
+		free (old_block);
+		return NULL;
+	}
+	if (old_block == NULL)
+		return malloc (new_size);
+
+	size_t old_size = header_of (old_block)->size;
+	if (new_size <= old_size)
+		return old_block;
+
+	void *new_block = malloc (new_size);
+	if (new_block != NULL) {
+		memcpy (new_block, old_block, old_size);
+		free (old_block);
+	}
+	return new_block;
+}
+
+/* Frees block P, which must have been previously allocated with
+   malloc(), calloc(), or realloc(). */
+void
+free (void *p) {
+	if (p == NULL)
+		return;
+
+	struct header *h = header_of (p);
+	if (h->class == LARGE) {
+		large_free_block ((struct large_block *) h);
+		return;
+	}
+
+	ASSERT (h->class < CLASS_CNT);
+	struct free_block *b = (struct free_block *) h;
+	b->next = free_lists[h->class];
+	free_lists[h->class] = b;
+}
@@ -155,6 +155,41 @@ munmap (void *addr) {
 	syscall1 (SYS_MUNMAP, addr);
 }
 
+int
+madvise (void *addr, size_t length, int advice) {
+	return syscall3 (SYS_MADVISE, addr, length, advice);
+}
+
+int
+msync (void *addr, size_t length) {
+	return syscall2 (SYS_MSYNC, addr, length);
+}
+
+void *
+sbrk (intptr_t increment) {
+	return (void *) syscall1 (SYS_SBRK, increment);
+}
+
+pid_t
+spawn (const char *file) {
+	return (pid_t) syscall1 (SYS_SPAWN, file);
+}
+
+int
+memstat (struct memstat *ms) {
+	return syscall1 (SYS_MEMSTAT, ms);
+}
+
+int
+set_rss_limit (size_t pages) {
+	return syscall1 (SYS_SET_RSS_LIMIT, pages);
+}
+
+int
+fallocate (int fd, off_t offset, off_t length) {
+	return syscall3 (SYS_FALLOCATE, fd, offset, length);
+}
+
 bool
 chdir (const char *dir) {
 	return syscall1 (SYS_CHDIR, dir);
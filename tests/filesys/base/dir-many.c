@@ -0,0 +1,61 @@
+/* Creates many files in the root directory, then opens, removes
+   and re-creates them, exercising hashed directory lookups and
+   insertion into slots freed by removal. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 384
+
+static char name[16];
+
+static const char *
+file_name (int i)
+{
+  snprintf (name, sizeof name, "f%d", i);
+  return name;
+}
+
+void
+test_main (void)
+{
+  int i, fd;
+
+  for (i = 0; i < FILE_CNT; i++)
+    if (!create (file_name (i), 0))
+      fail ("create \"%s\"", file_name (i));
+  msg ("created %d files", FILE_CNT);
+
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      if ((fd = open (file_name (i))) < 2)
+        fail ("open \"%s\"", file_name (i));
+      close (fd);
+    }
+  msg ("opened %d files", FILE_CNT);
+
+  CHECK (open ("missing") == -1, "open \"missing\" fails");
+
+  for (i = 0; i < FILE_CNT; i += 2)
+    if (!remove (file_name (i)))
+      fail ("remove \"%s\"", file_name (i));
+  msg ("removed every other file");
+
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      fd = open (file_name (i));
+      if ((fd >= 2) != (i % 2 == 1))
+        fail ("open \"%s\" returned %d", file_name (i), fd);
+      if (fd >= 2)
+        close (fd);
+    }
+  msg ("only remaining files can be opened");
+
+  for (i = 0; i < FILE_CNT; i += 2)
+    if (!create (file_name (i), 0))
+      fail ("re-create \"%s\"", file_name (i));
+  CHECK (!create (file_name (1), 0), "create existing \"%s\" fails", file_name (1));
+  msg ("re-created removed files");
+}
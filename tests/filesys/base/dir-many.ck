@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-many) begin
+(dir-many) created 384 files
+(dir-many) opened 384 files
+(dir-many) open "missing" fails
+(dir-many) removed every other file
+(dir-many) only remaining files can be opened
+(dir-many) create existing "f1" fails
+(dir-many) re-created removed files
+(dir-many) end
+EOF
+pass;
@@ -0,0 +1,37 @@
+/* Reserves space for a file with fallocate(), checks that the
+   file's size is unchanged, then grows the file into the
+   reserved space 1,000 bytes at a time. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[20000];
+
+void
+test_main (void) 
+{
+  const char *file_name = "reserved";
+  size_t ofs;
+  int fd;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (fallocate (fd, 0, sizeof buf) == 0, "fallocate \"%s\"", file_name);
+  if (filesize (fd) != 0)
+    fail ("fallocate changed size of \"%s\" to %d", file_name, filesize (fd));
+
+  msg ("writing \"%s\"", file_name);
+  for (ofs = 0; ofs < sizeof buf; ofs += 1000)
+    if (write (fd, buf + ofs, 1000) != 1000)
+      fail ("write 1000 bytes at offset %zu in \"%s\" failed", ofs, file_name);
+  if (filesize (fd) != (int) sizeof buf)
+    fail ("filesize not updated properly: should be %zu, actually %d",
+          sizeof buf, filesize (fd));
+
+  msg ("close \"%s\"", file_name);
+  close (fd);
+  check_file (file_name, buf, sizeof buf);
+}
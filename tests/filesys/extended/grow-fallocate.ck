@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(grow-fallocate) begin
+(grow-fallocate) create "reserved"
+(grow-fallocate) open "reserved"
+(grow-fallocate) fallocate "reserved"
+(grow-fallocate) writing "reserved"
+(grow-fallocate) close "reserved"
+(grow-fallocate) open "reserved" for verification
+(grow-fallocate) verified contents of "reserved"
+(grow-fallocate) close "reserved"
+(grow-fallocate) end
+EOF
+pass;
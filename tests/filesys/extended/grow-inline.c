@@ -0,0 +1,38 @@
+/* Writes a file small enough to be stored inside its inode,
+   then grows it well past that size and checks that the early
+   contents survive the move to separate data blocks. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[3000];
+
+void
+test_main (void) 
+{
+  const char *file_name = "small";
+  int fd;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+
+  CHECK (write (fd, buf, 100) == 100, "write 100 bytes to \"%s\"", file_name);
+  if (filesize (fd) != 100)
+    fail ("filesize not updated properly: should be 100, actually %d",
+          filesize (fd));
+  seek (fd, 0);
+  check_file_handle (fd, file_name, buf, 100);
+
+  CHECK (write (fd, buf + 100, sizeof buf - 100) == sizeof buf - 100,
+         "write %zu more bytes to \"%s\"", sizeof buf - 100, file_name);
+  if (filesize (fd) != (int) sizeof buf)
+    fail ("filesize not updated properly: should be %zu, actually %d",
+          sizeof buf, filesize (fd));
+
+  msg ("close \"%s\"", file_name);
+  close (fd);
+  check_file (file_name, buf, sizeof buf);
+}
@@ -0,0 +1,62 @@
+/* Grows two files in parallel, 512 bytes at a time, and checks
+   that each file's data still lies in a few contiguous runs on
+   disk and that their contents are correct. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE 65536
+#define CHUNK_SIZE 512
+#define MAX_EXTENTS 16
+static char buf_a[FILE_SIZE];
+static char buf_b[FILE_SIZE];
+
+static void
+check_extents (const char *file_name, int fd) 
+{
+  long long extents = get_file_extents (fd);
+  if (extents < 1 || extents > MAX_EXTENTS)
+    fail ("\"%s\" is split into %lld runs on disk (max %d)",
+          file_name, extents, MAX_EXTENTS);
+}
+
+void
+test_main (void) 
+{
+  int fd_a, fd_b;
+  size_t ofs;
+
+  random_init (0);
+  random_bytes (buf_a, sizeof buf_a);
+  random_bytes (buf_b, sizeof buf_b);
+
+  CHECK (create ("a", 0), "create \"a\"");
+  CHECK (create ("b", 0), "create \"b\"");
+
+  CHECK ((fd_a = open ("a")) > 1, "open \"a\"");
+  CHECK ((fd_b = open ("b")) > 1, "open \"b\"");
+
+  msg ("write \"a\" and \"b\" alternately");
+  for (ofs = 0; ofs < FILE_SIZE; ofs += CHUNK_SIZE) 
+    {
+      if (write (fd_a, buf_a + ofs, CHUNK_SIZE) != CHUNK_SIZE)
+        fail ("write %d bytes at offset %zu in \"a\" failed", CHUNK_SIZE, ofs);
+      if (write (fd_b, buf_b + ofs, CHUNK_SIZE) != CHUNK_SIZE)
+        fail ("write %d bytes at offset %zu in \"b\" failed", CHUNK_SIZE, ofs);
+    }
+
+  msg ("check fragmentation");
+  check_extents ("a", fd_a);
+  check_extents ("b", fd_b);
+
+  msg ("close \"a\"");
+  close (fd_a);
+
+  msg ("close \"b\"");
+  close (fd_b);
+
+  check_file ("a", buf_a, FILE_SIZE);
+  check_file ("b", buf_b, FILE_SIZE);
+}
@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::random;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(grow-interleave) begin
+(grow-interleave) create "a"
+(grow-interleave) create "b"
+(grow-interleave) open "a"
+(grow-interleave) open "b"
+(grow-interleave) write "a" and "b" alternately
+(grow-interleave) check fragmentation
+(grow-interleave) close "a"
+(grow-interleave) close "b"
+(grow-interleave) open "a" for verification
+(grow-interleave) verified contents of "a"
+(grow-interleave) close "a"
+(grow-interleave) open "b" for verification
+(grow-interleave) verified contents of "b"
+(grow-interleave) close "b"
+(grow-interleave) end
+EOF
+pass;
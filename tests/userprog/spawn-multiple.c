@@ -0,0 +1,16 @@
+/* Spawns and waits for multiple child processes without
+   copying the parent's address space. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int i;
+
+  CHECK (spawn ("no-such-file") == -1, "spawn(\"no-such-file\")");
+  for (i = 0; i < 4; i++)
+    msg ("wait(spawn()) = %d", wait (spawn ("child-simple")));
+}
@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(spawn-multiple) begin
+load: no-such-file: open failed
+no-such-file: exit(-1)
+(spawn-multiple) spawn("no-such-file")
+(child-simple) run
+child-simple: exit(81)
+(spawn-multiple) wait(spawn()) = 81
+(child-simple) run
+child-simple: exit(81)
+(spawn-multiple) wait(spawn()) = 81
+(child-simple) run
+child-simple: exit(81)
+(spawn-multiple) wait(spawn()) = 81
+(child-simple) run
+child-simple: exit(81)
+(spawn-multiple) wait(spawn()) = 81
+(spawn-multiple) end
+spawn-multiple: exit(0)
+EOF
+pass;
@@ -0,0 +1,37 @@
+/* Spawns itself recursively to the depth indicated by the
+   first command-line argument. */
+
+#include <debug.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char *test_name = "spawn-recurse";
+
+int
+main (int argc UNUSED, char *argv[]) 
+{
+  int n = atoi (argv[1]);
+
+  msg ("begin %d", n);
+  if (n != 0) 
+    {
+      char child_cmd[128];
+      pid_t child_pid;
+      int code;
+      
+      snprintf (child_cmd, sizeof child_cmd, "spawn-recurse %d", n - 1);
+      msg ("spawn(\"%s\")", child_cmd);
+      child_pid = spawn (child_cmd);
+      if (child_pid < 0)
+        fail ("spawn() returned %d", child_pid);
+
+      code = wait (child_pid);
+      if (code != n - 1)
+        fail ("wait(spawn(\"%s\")) returned %d", child_cmd, code);
+    }
+  
+  msg ("end %d", n);
+  return n;
+}
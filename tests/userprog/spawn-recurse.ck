@@ -0,0 +1,70 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(spawn-recurse) begin 15
+(spawn-recurse) spawn("spawn-recurse 14")
+(spawn-recurse) begin 14
+(spawn-recurse) spawn("spawn-recurse 13")
+(spawn-recurse) begin 13
+(spawn-recurse) spawn("spawn-recurse 12")
+(spawn-recurse) begin 12
+(spawn-recurse) spawn("spawn-recurse 11")
+(spawn-recurse) begin 11
+(spawn-recurse) spawn("spawn-recurse 10")
+(spawn-recurse) begin 10
+(spawn-recurse) spawn("spawn-recurse 9")
+(spawn-recurse) begin 9
+(spawn-recurse) spawn("spawn-recurse 8")
+(spawn-recurse) begin 8
+(spawn-recurse) spawn("spawn-recurse 7")
+(spawn-recurse) begin 7
+(spawn-recurse) spawn("spawn-recurse 6")
+(spawn-recurse) begin 6
+(spawn-recurse) spawn("spawn-recurse 5")
+(spawn-recurse) begin 5
+(spawn-recurse) spawn("spawn-recurse 4")
+(spawn-recurse) begin 4
+(spawn-recurse) spawn("spawn-recurse 3")
+(spawn-recurse) begin 3
+(spawn-recurse) spawn("spawn-recurse 2")
+(spawn-recurse) begin 2
+(spawn-recurse) spawn("spawn-recurse 1")
+(spawn-recurse) begin 1
+(spawn-recurse) spawn("spawn-recurse 0")
+(spawn-recurse) begin 0
+(spawn-recurse) end 0
+spawn-recurse: exit(0)
+(spawn-recurse) end 1
+spawn-recurse: exit(1)
+(spawn-recurse) end 2
+spawn-recurse: exit(2)
+(spawn-recurse) end 3
+spawn-recurse: exit(3)
+(spawn-recurse) end 4
+spawn-recurse: exit(4)
+(spawn-recurse) end 5
+spawn-recurse: exit(5)
+(spawn-recurse) end 6
+spawn-recurse: exit(6)
+(spawn-recurse) end 7
+spawn-recurse: exit(7)
+(spawn-recurse) end 8
+spawn-recurse: exit(8)
+(spawn-recurse) end 9
+spawn-recurse: exit(9)
+(spawn-recurse) end 10
+spawn-recurse: exit(10)
+(spawn-recurse) end 11
+spawn-recurse: exit(11)
+(spawn-recurse) end 12
+spawn-recurse: exit(12)
+(spawn-recurse) end 13
+spawn-recurse: exit(13)
+(spawn-recurse) end 14
+spawn-recurse: exit(14)
+(spawn-recurse) end 15
+spawn-recurse: exit(15)
+EOF
+pass;
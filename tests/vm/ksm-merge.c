@@ -0,0 +1,62 @@
+/* Fills several anonymous pages with the same contents, waits
+   for the same-page merging daemon to merge them, then checks
+   that writes from user code and from read() each give the
+   written page a private copy without touching the others. */
+
+#include <round.h>
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 8
+#define FILL 0x5a
+
+static char buf[(PAGE_CNT + 1) * PAGE_SIZE];
+
+static void
+check_fill (const char *page, size_t idx)
+{
+  size_t i;
+
+  for (i = 0; i < PAGE_SIZE; i++)
+    if (page[i] != FILL)
+      fail ("byte %zu of page %zu has value %02hhx (should be %02x)",
+            i, idx, page[i], FILL);
+}
+
+void
+test_main (void)
+{
+  char *pages = (char *) ROUND_UP ((uintptr_t) buf, PAGE_SIZE);
+  int handle;
+  size_t i;
+
+  msg ("fill %d pages", PAGE_CNT);
+  for (i = 0; i < PAGE_CNT; i++)
+    memset (pages + i * PAGE_SIZE, FILL, PAGE_SIZE);
+
+  msg ("wait for merging");
+  while (get_ksm_pages_sharing () < PAGE_CNT - 1)
+    continue;
+
+  msg ("write to page 0");
+  pages[0] = 1;
+  if (pages[0] != 1)
+    fail ("write to merged page was lost");
+  check_fill (pages + PAGE_SIZE, 1);
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (read (handle, pages + 2 * PAGE_SIZE, PAGE_SIZE) == (int) strlen (sample),
+         "read \"sample.txt\" into page 2");
+  if (memcmp (pages + 2 * PAGE_SIZE, sample, strlen (sample)))
+    fail ("read of \"sample.txt\" reported bad data");
+  close (handle);
+
+  msg ("check other pages");
+  for (i = 3; i < PAGE_CNT; i++)
+    check_fill (pages + i * PAGE_SIZE, i);
+}
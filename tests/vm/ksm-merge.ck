@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(ksm-merge) begin
+(ksm-merge) fill 8 pages
+(ksm-merge) wait for merging
+(ksm-merge) write to page 0
+(ksm-merge) open "sample.txt"
+(ksm-merge) read "sample.txt" into page 2
+(ksm-merge) check other pages
+(ksm-merge) end
+EOF
+pass;
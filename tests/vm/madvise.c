@@ -0,0 +1,45 @@
+/* Checks that madvise() loads pages ahead of use with MADV_WILLNEED
+   and releases them with MADV_DONTNEED. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHUNK_PAGE_COUNT 3
+#define CHUNK_SIZE (CHUNK_PAGE_COUNT * PAGE_SIZE)
+
+static char buf[CHUNK_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  int handle;
+  size_t i;
+
+  CHECK (madvise (buf + 1, PAGE_SIZE, MADV_DONTNEED) == -1,
+         "misaligned madvise fails");
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (actual, PAGE_SIZE, 0, handle, 0) != MAP_FAILED,
+         "mmap \"sample.txt\"");
+  CHECK (get_phys_addr (actual) == 0, "check if page is not loaded");
+  CHECK (madvise (actual, PAGE_SIZE, MADV_WILLNEED) == 0, "madvise WILLNEED");
+  CHECK (get_phys_addr (actual) != 0, "check if page is loaded");
+  CHECK (!memcmp (actual, sample, strlen (sample)), "check memory content");
+
+  for (i = 0; i < CHUNK_PAGE_COUNT; i++)
+    buf[i * PAGE_SIZE] = 'x';
+  CHECK (madvise (buf, CHUNK_SIZE, MADV_DONTNEED) == 0, "madvise DONTNEED");
+  for (i = 0; i < CHUNK_PAGE_COUNT; i++)
+    CHECK (get_phys_addr (&buf[i * PAGE_SIZE]) == 0,
+           "check if page is released");
+  for (i = 0; i < CHUNK_PAGE_COUNT; i++)
+    CHECK (buf[i * PAGE_SIZE] == 0, "check if page is zero-filled");
+
+  munmap (actual);
+  close (handle);
+}
@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(madvise) begin
+(madvise) misaligned madvise fails
+(madvise) open "sample.txt"
+(madvise) mmap "sample.txt"
+(madvise) check if page is not loaded
+(madvise) madvise WILLNEED
+(madvise) check if page is loaded
+(madvise) check memory content
+(madvise) madvise DONTNEED
+(madvise) check if page is released
+(madvise) check if page is released
+(madvise) check if page is released
+(madvise) check if page is zero-filled
+(madvise) check if page is zero-filled
+(madvise) check if page is zero-filled
+(madvise) end
+EOF
+pass;
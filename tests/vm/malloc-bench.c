@@ -0,0 +1,90 @@
+/* Allocation-heavy workload on the user heap: many small objects
+   with short lifetimes, a few large buffers, and growing arrays
+   built with realloc().  Every block is filled with a pattern and
+   checked before it is freed.  The test's running time is the
+   benchmark result. */
+
+#include <malloc.h>
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SLOT_CNT 256
+#define ROUNDS 20000
+#define LARGE_MAX (32 * 1024)
+
+static unsigned char *slots[SLOT_CNT];
+static size_t sizes[SLOT_CNT];
+
+static void
+fill (size_t i)
+{
+  memset (slots[i], (int) i, sizes[i]);
+}
+
+static void
+verify (size_t i)
+{
+  size_t j;
+
+  for (j = 0; j < sizes[i]; j++)
+    if (slots[i][j] != (unsigned char) i)
+      fail ("block %zu corrupted at byte %zu", i, j);
+}
+
+void
+test_main (void)
+{
+  char *heap_start = sbrk (0);
+  size_t r, i;
+
+  random_init (0);
+  for (r = 0; r < ROUNDS; r++)
+    {
+      i = random_ulong () % SLOT_CNT;
+      if (slots[i] == NULL)
+        {
+          /* Mostly small objects, sometimes a large buffer. */
+          sizes[i] = random_ulong () % 8 != 0
+                     ? random_ulong () % 256 + 1
+                     : random_ulong () % LARGE_MAX + 1;
+          slots[i] = malloc (sizes[i]);
+          if (slots[i] == NULL)
+            fail ("malloc of %zu bytes failed", sizes[i]);
+          fill (i);
+        }
+      else if (random_ulong () % 4 == 0)
+        {
+          /* Grow an array in place or by moving it. */
+          verify (i);
+          sizes[i] += random_ulong () % 512 + 1;
+          slots[i] = realloc (slots[i], sizes[i]);
+          if (slots[i] == NULL)
+            fail ("realloc to %zu bytes failed", sizes[i]);
+          fill (i);
+        }
+      else
+        {
+          verify (i);
+          free (slots[i]);
+          slots[i] = NULL;
+        }
+    }
+  msg ("%d rounds of malloc, realloc and free", ROUNDS);
+
+  for (i = 0; i < SLOT_CNT; i++)
+    if (slots[i] != NULL)
+      {
+        verify (i);
+        free (slots[i]);
+      }
+  msg ("free all blocks");
+
+  /* Freed memory must be reused rather than growing the heap
+     without bound. */
+  if ((size_t) ((char *) sbrk (0) - heap_start) > SLOT_CNT * (LARGE_MAX + 4096))
+    fail ("heap grew to %zu bytes", (size_t) ((char *) sbrk (0) - heap_start));
+  msg ("check heap size");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(malloc-bench) begin
+(malloc-bench) 20000 rounds of malloc, realloc and free
+(malloc-bench) free all blocks
+(malloc-bench) check heap size
+(malloc-bench) end
+EOF
+pass;
@@ -0,0 +1,46 @@
+/* Maps anonymous memory with and without MAP_POPULATE and checks
+   that it is zero-filled, writable, and loaded only when asked. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 4
+#define LAZY ((char *) 0x10000000)
+#define POPULATED ((char *) 0x20000000)
+
+void
+test_main (void)
+{
+  size_t i;
+
+  CHECK (mmap (LAZY, PAGE_SIZE, 1 | MAP_ANONYMOUS, 3, 0) == MAP_FAILED,
+         "anonymous mmap with a file descriptor fails");
+
+  CHECK (mmap (LAZY, PAGE_COUNT * PAGE_SIZE, 1, -1, 0) != MAP_FAILED,
+         "mmap anonymous");
+  CHECK (get_phys_addr (LAZY) == 0, "check if page is not loaded");
+
+  CHECK (mmap (POPULATED, PAGE_COUNT * PAGE_SIZE, 1 | MAP_ANONYMOUS | MAP_POPULATE,
+               -1, 0) != MAP_FAILED, "mmap anonymous with MAP_POPULATE");
+  for (i = 0; i < PAGE_COUNT; i++)
+    CHECK (get_phys_addr (POPULATED + i * PAGE_SIZE) != 0,
+           "check if page is loaded");
+
+  for (i = 0; i < PAGE_COUNT * PAGE_SIZE; i++)
+    if (LAZY[i] != 0 || POPULATED[i] != 0)
+      fail ("byte %zu is not zero", i);
+  msg ("check if memory is zero-filled");
+
+  memset (LAZY, 'a', PAGE_COUNT * PAGE_SIZE);
+  memset (POPULATED, 'b', PAGE_COUNT * PAGE_SIZE);
+  for (i = 0; i < PAGE_COUNT * PAGE_SIZE; i++)
+    if (LAZY[i] != 'a' || POPULATED[i] != 'b')
+      fail ("byte %zu was not written", i);
+  msg ("check memory content");
+
+  munmap (LAZY);
+  munmap (POPULATED);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-anon) begin
+(mmap-anon) anonymous mmap with a file descriptor fails
+(mmap-anon) mmap anonymous
+(mmap-anon) check if page is not loaded
+(mmap-anon) mmap anonymous with MAP_POPULATE
+(mmap-anon) check if page is loaded
+(mmap-anon) check if page is loaded
+(mmap-anon) check if page is loaded
+(mmap-anon) check if page is loaded
+(mmap-anon) check if memory is zero-filled
+(mmap-anon) check memory content
+(mmap-anon) end
+EOF
+pass;
@@ -0,0 +1,42 @@
+/* Writes to a file through a mapping and flushes it with msync(),
+   then reads the data in the file back using the read system
+   call while the mapping is still in place. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 3
+#define FILE_SIZE (PAGE_COUNT * PAGE_SIZE)
+#define ACTUAL ((char *) 0x10000000)
+
+static char buf[FILE_SIZE];
+
+void
+test_main (void)
+{
+  int handle;
+  size_t i;
+
+  CHECK (create ("msync.dat", FILE_SIZE), "create \"msync.dat\"");
+  CHECK ((handle = open ("msync.dat")) > 1, "open \"msync.dat\"");
+  CHECK (mmap (ACTUAL, FILE_SIZE, 1, handle, 0) != MAP_FAILED,
+         "mmap \"msync.dat\"");
+
+  for (i = 0; i < FILE_SIZE; i++)
+    ACTUAL[i] = i % 251;
+  CHECK (msync (ACTUAL + 1, PAGE_SIZE) == -1, "misaligned msync fails");
+  CHECK (msync (ACTUAL, FILE_SIZE) == 0, "msync \"msync.dat\"");
+
+  /* Read back via read() without unmapping. */
+  CHECK (read (handle, buf, FILE_SIZE) == FILE_SIZE, "read \"msync.dat\"");
+  for (i = 0; i < FILE_SIZE; i++)
+    if (buf[i] != (char) (i % 251))
+      fail ("byte %zu of file is %d, expected %d", i, buf[i], (int) (i % 251));
+  msg ("compare read data against written data");
+
+  munmap (ACTUAL);
+  close (handle);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-msync) begin
+(mmap-msync) create "msync.dat"
+(mmap-msync) open "msync.dat"
+(mmap-msync) mmap "msync.dat"
+(mmap-msync) misaligned msync fails
+(mmap-msync) msync "msync.dat"
+(mmap-msync) read "msync.dat"
+(mmap-msync) compare read data against written data
+(mmap-msync) end
+EOF
+pass;
@@ -0,0 +1,45 @@
+/* Caps the process's resident set, touches four times as many
+   pages, and checks that the cap holds, that the pages over it
+   were swapped out, and that their contents survive. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define LIMIT 32
+#define PAGE_COUNT (4 * LIMIT)
+#define ADDR ((char *) 0x10000000)
+
+void
+test_main (void)
+{
+  struct memstat ms;
+  size_t i;
+
+  CHECK (set_rss_limit (1) == -1, "limit below the minimum is rejected");
+  CHECK (set_rss_limit (LIMIT) == 0, "set_rss_limit (%d)", LIMIT);
+
+  CHECK (mmap (ADDR, PAGE_COUNT * PAGE_SIZE, 1, -1, 0) != MAP_FAILED,
+         "mmap anonymous");
+  for (i = 0; i < PAGE_COUNT; i++)
+    memset (ADDR + i * PAGE_SIZE, i, PAGE_SIZE);
+
+  CHECK (memstat (&ms) == 0, "memstat");
+  if (ms.rss_limit != LIMIT)
+    fail ("limit is %zu", ms.rss_limit);
+  if (ms.resident > LIMIT)
+    fail ("%zu pages resident", ms.resident);
+  msg ("resident pages within limit");
+  if (ms.swapped < PAGE_COUNT - LIMIT)
+    fail ("only %zu pages swapped", ms.swapped);
+  msg ("pages over the limit were swapped out");
+
+  for (i = 0; i < PAGE_COUNT * PAGE_SIZE; i++)
+    if (ADDR[i] != (char) (i / PAGE_SIZE))
+      fail ("byte %zu is wrong", i);
+  msg ("contents survive eviction");
+
+  munmap (ADDR);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(rss-limit) begin
+(rss-limit) limit below the minimum is rejected
+(rss-limit) set_rss_limit (32)
+(rss-limit) mmap anonymous
+(rss-limit) memstat
+(rss-limit) resident pages within limit
+(rss-limit) pages over the limit were swapped out
+(rss-limit) contents survive eviction
+(rss-limit) end
+EOF
+pass;
@@ -0,0 +1,40 @@
+/* Grows the heap with sbrk(), checks that new pages are loaded
+   lazily and zero-filled, then shrinks it back. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 8
+
+void
+test_main (void)
+{
+  char *start, *heap;
+  size_t i;
+
+  start = sbrk (0);
+  CHECK (start != (void *) -1, "sbrk (0)");
+  CHECK (sbrk (-1) == (void *) -1, "shrink below heap start fails");
+
+  CHECK ((heap = sbrk (PAGE_COUNT * PAGE_SIZE)) == start, "grow heap");
+  CHECK (sbrk (0) == start + PAGE_COUNT * PAGE_SIZE, "check new break");
+  CHECK (get_phys_addr (heap) == 0, "check if page is not loaded");
+
+  for (i = 0; i < PAGE_COUNT * PAGE_SIZE; i++)
+    if (heap[i] != 0)
+      fail ("byte %zu is not zero", i);
+  msg ("check if memory is zero-filled");
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    heap[i * PAGE_SIZE] = 'x';
+  CHECK (sbrk (-(PAGE_COUNT / 2) * PAGE_SIZE) == start + PAGE_COUNT * PAGE_SIZE,
+         "shrink heap");
+  CHECK (get_phys_addr (heap + (PAGE_COUNT / 2) * PAGE_SIZE) == 0,
+         "check if page is released");
+  CHECK (heap[0] == 'x', "check memory content");
+
+  CHECK (sbrk ((PAGE_COUNT / 2) * PAGE_SIZE) != (void *) -1, "grow heap again");
+  CHECK (heap[(PAGE_COUNT / 2) * PAGE_SIZE] == 0, "check if page is zero-filled");
+}
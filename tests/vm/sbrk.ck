@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(sbrk) begin
+(sbrk) sbrk (0)
+(sbrk) shrink below heap start fails
+(sbrk) grow heap
+(sbrk) check new break
+(sbrk) check if page is not loaded
+(sbrk) check if memory is zero-filled
+(sbrk) shrink heap
+(sbrk) check if page is released
+(sbrk) check memory content
+(sbrk) grow heap again
+(sbrk) check if page is zero-filled
+(sbrk) end
+EOF
+pass;
@@ -0,0 +1,38 @@
+/* Touches many pages of a large anonymous mapping and checks that
+   the kernel memory spent on page metadata stays small per page
+   and is given back by munmap. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 8192
+#define MAX_BYTES_PER_PAGE 192
+#define ADDR ((char *) 0x10000000)
+
+void
+test_main (void)
+{
+  long long before, mapped, after;
+  size_t i;
+  int sum = 0;
+
+  before = get_spt_bytes ();
+  CHECK (before > 0, "get_spt_bytes");
+
+  CHECK (mmap (ADDR, PAGE_COUNT * PAGE_SIZE, 0, -1, 0) != MAP_FAILED,
+         "mmap anonymous");
+  for (i = 0; i < PAGE_COUNT; i++)
+    sum += ADDR[i * PAGE_SIZE];
+  CHECK (sum == 0, "read every page");
+
+  mapped = get_spt_bytes ();
+  if ((mapped - before) / PAGE_COUNT > MAX_BYTES_PER_PAGE)
+    fail ("%lld bytes of metadata per page", (mapped - before) / PAGE_COUNT);
+  msg ("metadata per page is small");
+
+  munmap (ADDR);
+  after = get_spt_bytes ();
+  CHECK (after <= before + PAGE_SIZE, "munmap releases metadata");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(spt-bytes) begin
+(spt-bytes) get_spt_bytes
+(spt-bytes) mmap anonymous
+(spt-bytes) read every page
+(spt-bytes) metadata per page is small
+(spt-bytes) munmap releases metadata
+(spt-bytes) end
+EOF
+pass;
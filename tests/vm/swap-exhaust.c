@@ -0,0 +1,56 @@
+/* Forks a child that touches far more anonymous memory than
+   physical memory and swap can hold together.  The child must be
+   killed with exit(-1) instead of the kernel panicking, and the
+   parent must keep running and be able to use memory again. */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHILD_PAGES (32 * 1024 * 1024 / PAGE_SIZE)
+#define PARENT_PAGES 64
+#define ADDR ((uint64_t *) 0x10000000)
+
+/* Fills each page with a distinct pseudo-random pattern, so that
+   neither the compressed swap cache nor page merging can keep
+   up with the child's demand. */
+static void
+fill (uint64_t *p, size_t pages)
+{
+  uint64_t x = 0x9e3779b97f4a7c15ULL;
+  size_t i;
+
+  for (i = 0; i < pages * PAGE_SIZE / sizeof *p; i++)
+    {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      p[i] = x;
+    }
+}
+
+void
+test_main (void)
+{
+  pid_t child;
+
+  CHECK ((child = fork ("oom-child")) != -1, "fork");
+  if (child == 0)
+    {
+      if (mmap (ADDR, CHILD_PAGES * PAGE_SIZE, 1, -1, 0) == MAP_FAILED)
+        exit (2);
+      fill (ADDR, CHILD_PAGES);
+      exit (1);
+    }
+
+  CHECK (wait (child) == -1, "child was killed");
+
+  CHECK (mmap (ADDR, PARENT_PAGES * PAGE_SIZE, 1, -1, 0) != MAP_FAILED,
+         "mmap anonymous");
+  fill (ADDR, PARENT_PAGES);
+  msg ("memory is usable again");
+  munmap (ADDR);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(swap-exhaust) begin
+(swap-exhaust) fork
+oom-child: exit(-1)
+(swap-exhaust) child was killed
+(swap-exhaust) mmap anonymous
+(swap-exhaust) memory is usable again
+(swap-exhaust) end
+swap-exhaust: exit(0)
+EOF
+pass;
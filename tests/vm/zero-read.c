@@ -0,0 +1,45 @@
+/* Reads untouched BSS pages, which may share a single zero
+   frame, then read()s a file into one of them and checks that
+   the others still read back as zeros. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+static char buf[3 * PAGE_SIZE];
+
+static void
+check_zeros (const char *p, size_t size)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    if (p[i] != 0)
+      fail ("byte %zu of zero page has value %02hhx (should be 0)",
+            i, p[i]);
+}
+
+void
+test_main (void)
+{
+  int handle;
+
+  msg ("read untouched pages");
+  check_zeros (buf, PAGE_SIZE);
+  check_zeros (buf + PAGE_SIZE, PAGE_SIZE);
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (read (handle, buf, PAGE_SIZE) == (int) strlen (sample),
+         "read \"sample.txt\" into first page");
+  if (memcmp (buf, sample, strlen (sample)))
+    fail ("read of \"sample.txt\" reported bad data");
+  close (handle);
+
+  msg ("check other pages");
+  check_zeros (buf + PAGE_SIZE, PAGE_SIZE);
+  check_zeros (buf + 2 * PAGE_SIZE, PAGE_SIZE);
+}
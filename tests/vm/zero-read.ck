@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(zero-read) begin
+(zero-read) read untouched pages
+(zero-read) open "sample.txt"
+(zero-read) read "sample.txt" into first page
+(zero-read) check other pages
+(zero-read) end
+EOF
+pass;
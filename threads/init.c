@@ -36,6 +36,7 @@
 /* 노트. VM이 정의되어 있는 경우에만 실행 */
 #ifdef VM
 #include "vm/vm.h"
+#include "vm/rss.h"
 #endif
 
 /* 노트. FILESYS가 정의되어 있는 경우에만 실행 */
@@ -44,6 +45,9 @@
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
 #endif
+#ifdef EFILESYS
+#include "filesys/fat.h"
+#endif
 
 /* 노트. Page-map-level-4는 페이지 테이블 라벨링 결정하는 방식이다 */
 /* Page-map-level-4 with kernel mappings only. */
@@ -292,6 +296,13 @@ parse_options (char **argv) {
 #ifdef FILESYS
 		else if (!strcmp (name, "-f"))
 			format_filesys = true;
+#endif
+#ifdef EFILESYS
+		else if (!strcmp (name, "-spc")) {
+			fat_format_spc = atoi (value);
+			if (fat_format_spc < 1 || fat_format_spc > SECTORS_PER_CLUSTER_MAX)
+				PANIC ("cluster size must be 1 to %d sectors", SECTORS_PER_CLUSTER_MAX);
+		}
 #endif
 		else if (!strcmp (name, "-rs"))
 			random_init (atoi (value));
@@ -302,6 +313,16 @@ parse_options (char **argv) {
 			user_page_limit = atoi (value);
 		else if (!strcmp (name, "-threads-tests"))
 			thread_tests = true;
+#endif
+#ifdef VM
+		else if (!strcmp (name, "-fa"))
+			vm_fault_around_pages = atoi (value);
+		else if (!strcmp (name, "-rss")) {
+			int pages = atoi (value);
+			if (pages < 0 || (pages != 0 && pages < RSS_LIMIT_MIN))
+				PANIC ("resident page limit must be 0 or at least %d pages", RSS_LIMIT_MIN);
+			vm_rss_default_limit = pages;
+		}
 #endif
 		else
 			PANIC ("unknown option `%s' (use -h for help)", name);
@@ -400,10 +421,17 @@ usage (void) {
 			"  -h                 Print this help message and power off.\n"
 			"  -q                 Power off VM after actions or on panic.\n"
 			"  -f                 Format file system disk during startup.\n"
+#ifdef EFILESYS
+			"  -spc=SECTORS       Sectors per cluster when formatting (1 to 64).\n"
+#endif
 			"  -rs=SEED           Set random number seed to SEED.\n"
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
+#endif
+#ifdef VM
+			"  -fa=PAGES          Fault-around window in pages (1 disables).\n"
+			"  -rss=PAGES         Resident pages per process (0 = no limit).\n"
 #endif
 			);
 	power_off ();
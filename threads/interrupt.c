@@ -14,6 +14,9 @@
 #ifdef USERPROG
 #include "userprog/gdt.h"
 #endif
+#ifdef VM
+#include "vm/rss.h"
+#endif
 
 /* Number of x86_64 interrupts. */
 #define INTR_CNT 256
@@ -413,6 +416,15 @@ intr_handler (struct intr_frame *frame) {
 		if (yield_on_return)
 			thread_yield ();
 	}
+
+#ifdef VM
+	/* Project 3. OOM : 사용자 모드로 돌아가기 직전 종료 대상이면 종료 (사용자 모드에서만 도는 프로세스 대비)
+	 * 사용자 코드를 실행하다 들어왔으므로 잡고 있는 락이 없음 */
+	if (frame->cs == SEL_UCSEG && thread_current ()->oom_killed) {
+		intr_enable ();
+		vm_oom_check ();
+	}
+#endif
 }
 
 /* Dumps interrupt frame F to the console, for debugging. */
@@ -16,6 +16,9 @@
 #ifdef USERPROG
 #include "userprog/process.h"
 #endif
+#ifdef VM
+#include "vm/rss.h"
+#endif
 
 /* Random value for struct thread's `magic' member.
    Used to detect stack overflow.  See the big comment at the top
@@ -393,6 +396,20 @@ thread_yield (void) {
 	intr_set_level (old_level);
 }
 
+/* Invoke function 'func' on all threads, passing along 'aux'.
+   This function must be called with interrupts off. */
+void
+thread_foreach (thread_action_func *func, void *aux) {
+	struct list_elem *e;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (e = list_begin (&all_list); e != list_end (&all_list); e = list_next (e)) {
+		struct thread *t = list_entry (e, struct thread, allelem);
+		func (t, aux);
+	}
+}
+
 /* 노트. 현재 진행 중인 스레드의 priority가 변경 되는 경우, donations 리스트에 있는 애들 보다 높아질 수 있음 
  * 이때는 새로 바뀐 priority가 적용될 수 있도록 조치해야 함
  */
@@ -552,6 +569,7 @@ init_thread (struct thread *t, const char *name, int priority) {
 	/* Proj 2-3. fork syscall */
 	list_init(&t->child_list);
 	sema_init(&t->fork_sema, 0);
+	t->load_success = false;
 
 	/* Proj 2-3. wait syscall */
 	sema_init(&t->wait_sema, 0);
@@ -559,6 +577,11 @@ init_thread (struct thread *t, const char *name, int priority) {
 
 	/* Proj 2-6. Denying write to executable */
 	t->running = NULL;	// 구조체 추가에 따른 초기화
+
+#ifdef VM
+	/* Project 3. RSS : 상주 페이지 수 상한 기본값 (fork 시에는 부모의 값을 물려받음) */
+	t->rss_limit = vm_rss_default_limit;
+#endif
 }
 
 /* Chooses and returns the next thread to be scheduled.  Should
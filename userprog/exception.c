@@ -4,7 +4,12 @@
 #include "userprog/gdt.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/synch.h"
+#include "userprog/syscall.h"
 #include "intrinsic.h"
+#ifdef VM
+#include "vm/rss.h"
+#endif
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
@@ -147,7 +152,14 @@ page_fault (struct intr_frame *f) {
 		curr->saving_rsp = f->rsp;
 	}
 
+	/* Count page faults. */
+	page_fault_cnt++;
+
 #ifdef VM
+	/* Project 3. OOM : 종료 대상으로 선택된 프로세스는 사용자 폴트에서 종료 */
+	if (user)
+		vm_oom_check ();
+
 	/* For project 3 and later. */
 	if (vm_try_handle_fault (f, fault_addr, user, write, not_present))
 		return;
@@ -157,10 +169,12 @@ page_fault (struct intr_frame *f) {
 	/* 현재의 PintOS는 오류 발생시 무조건 segmentation fault 발생 시키고 kill하여 종료 */
 	/* kill(-1) 처리 코드 삭제 및 fault_addr 유효성 검사 후 페이지 폴트 핸들러 함수 호출 */
 
-	exit(-1); 			// multi-oom and other Project2 test-cases
+	/* Project 3. OOM : 시스템 콜이 사용자 버퍼에 접근하다 폴트를 처리하지 못한 경우 (메모리 부족 등)
+	 * 사용자 메모리를 다루는 동안 잡고 있을 수 있는 락은 filesys_lock 뿐이므로 해제 후 종료 */
+	if (!user && lock_held_by_current_thread (&filesys_lock))
+		lock_release (&filesys_lock);
 
-	/* Count page faults. */
-	page_fault_cnt++;
+	exit(-1); 			// multi-oom and other Project2 test-cases
 
 	/* If the fault is true fault, show info and exit. */
 	printf ("Page fault at %p: %s error %s page in %s context.\n",
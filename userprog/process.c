@@ -32,6 +32,8 @@ static void process_cleanup (void);
 static bool load (const char *file_name, struct intr_frame *if_);
 static void initd (void *f_name);
 static void __do_fork (void *);
+static void __do_spawn (void *);
+static bool exec_load (char *file_name, struct intr_frame *if_);
 
 /* General process initializer for initd and other process. */
 static void
@@ -227,6 +229,7 @@ __do_fork (void *aux) {
 
 	process_activate (current);
 #ifdef VM
+	current->rss_limit = parent->rss_limit;					// Project 3. RSS : 상주 페이지 수 상한 상속
 	supplemental_page_table_init (&current->spt);
 	if (!supplemental_page_table_copy (&current->spt, &parent->spt))
 		goto error;
@@ -310,6 +313,62 @@ error:
 	// thread_exit ();
 }
 
+/* Project 3. SPAWN : 부모의 주소 공간과 FD를 복사하지 않고 CMD_LINE의 실행 파일로 바로 자식 프로세스 생성
+ * fork 후 바로 exec 하는 경우의 복사 비용을 없앰. 자식은 콘솔 FD만 가진 상태로 시작
+ * 자식이 로드를 마칠 때까지 기다렸다가 자식의 tid 리턴 (로드 실패 시 TID_ERROR) */
+tid_t
+process_spawn (const char *cmd_line) {
+	char *fn_copy = palloc_get_page (0);
+	if (fn_copy == NULL)
+		return TID_ERROR;
+	strlcpy (fn_copy, cmd_line, PGSIZE);
+
+	char name[16], *save_ptr;											// 스레드 이름은 프로그램명
+	strlcpy (name, cmd_line, sizeof name);
+	strtok_r (name, " ", &save_ptr);
+
+	tid_t tid = thread_create (name, PRI_DEFAULT, __do_spawn, fn_copy);
+	if (tid == TID_ERROR) {
+		palloc_free_page (fn_copy);
+		return TID_ERROR;
+	}
+
+	struct thread *child = get_child_with_pid (tid);
+	sema_down (&child->fork_sema);										// fork와 같이 자식의 로드가 끝날 때까지 대기
+	if (!child->load_success) {											// 자식이 로드 후 바로 exit(-1) 할 수 있으므로 exit_status로 판단하지 않음
+		process_wait (tid);												// 로드에 실패한 자식이 종료될 때까지 기다렸다가 정리
+		return TID_ERROR;
+	}
+
+	return tid;
+}
+
+/* Project 3. SPAWN : spawn 된 자식 스레드가 실행하는 함수 (initd와 같이 새 주소 공간에 바로 로드) */
+static void
+__do_spawn (void *f_name) {
+	struct thread *current = thread_current ();
+	struct intr_frame _if;
+
+#ifdef VM
+	supplemental_page_table_init (&current->spt);
+#endif
+
+	process_init ();
+
+	bool success = exec_load (f_name, &_if);
+	palloc_free_page (f_name);
+	if (!success) {
+		current->exit_status = TID_ERROR;
+		sema_up (&current->fork_sema);									// 로드 실패를 부모에게 전달
+		thread_exit ();
+	}
+
+	current->load_success = true;
+	sema_up (&current->fork_sema);										// 로드 성공을 부모에게 전달
+	do_iret (&_if);
+	NOT_REACHED ();
+}
+
 /* Switch the current execution context to the f_name.
  * Returns -1 on fail. */
 int
@@ -321,9 +380,6 @@ process_exec (void *f_name) {
 	 * This is because when current thread rescheduled,
 	 * it stores the execution information to the member. */
 	struct intr_frame _if;
-	_if.ds = _if.es = _if.ss = SEL_UDSEG;
-	_if.cs = SEL_UCSEG;
-	_if.eflags = FLAG_IF | FLAG_MBS;
 
 	/* We first kill the current context */
 	process_cleanup ();
@@ -333,6 +389,31 @@ process_exec (void *f_name) {
 	supplemental_page_table_init(&thread_current()->spt);
 #endif
 
+	/* And then load the binary */
+	success = exec_load (file_name, &_if);
+
+	/* If load failed, quit. */
+	if (!success)
+	{
+		palloc_free_page(file_name);
+		return -1;
+	}
+
+	palloc_free_page(file_name);
+
+	/* Start switched process. */
+	do_iret (&_if);
+	NOT_REACHED ();
+}
+
+/* Project 3. SPAWN : process_exec와 spawn이 함께 쓰도록 분리
+ * FILE_NAME의 인자를 나누어 실행 파일을 로드하고 인자를 유저 스택에 올린 뒤 IF_ 세팅 */
+static bool
+exec_load (char *file_name, struct intr_frame *if_) {
+	if_->ds = if_->es = if_->ss = SEL_UDSEG;
+	if_->cs = SEL_UCSEG;
+	if_->eflags = FLAG_IF | FLAG_MBS;
+
 	/* P2-1. Parsing
 	 * argv[]는 인자를 저장 할 배열
 	 * argc는 인자의 개수를 세는 카운터
@@ -354,29 +435,18 @@ process_exec (void *f_name) {
 	// argc는 2 저장
 
 	/* And then load the binary */
-	success = load (file_name, &_if);
-
-	/* If load failed, quit. */
-	if (!success)
-	{
-		palloc_free_page(file_name);
-		return -1;
-	}
-
+	if (!load (file_name, if_))
+		return false;
 
     /* P2-1. Load arguments onto the USER_STACK */
-	void **rspp = &_if.rsp; // interupt frame의 stack pointer
+	void **rspp = &if_->rsp; // interupt frame의 stack pointer
 	argument_stack(argv, argc, rspp); // argv, argc, rspp 전달
-	_if.R.rdi = argc; // 결과물 저장 (rdi에 인자 개수)
-	_if.R.rsi = (uint64_t)*rspp + sizeof(void *); // 결과물 저장 (rsi에 argv[0] 값 저장 주소 포인터)
+	if_->R.rdi = argc; // 결과물 저장 (rdi에 인자 개수)
+	if_->R.rsi = (uint64_t)*rspp + sizeof(void *); // 결과물 저장 (rsi에 argv[0] 값 저장 주소 포인터)
 
 	/* Proj 2-1. Debugging */
-	// hex_dump(_if.rsp, _if.rsp, USER_STACK - (uint64_t)*rspp, true);
-	palloc_free_page(file_name);
-
-	/* Start switched process. */
-	do_iret (&_if);
-	NOT_REACHED ();
+	// hex_dump(if_->rsp, if_->rsp, USER_STACK - (uint64_t)*rspp, true);
+	return true;
 }
 
 /* Load user stack with arguments
@@ -897,32 +967,100 @@ install_page (void *upage, void *kpage, bool writable) {
  * If you want to implement the function for only project 2, implement it on the
  * upper block. */
 
+static bool lazy_load_segment (struct page *page, void *aux);
+
+/* Project 3. VMA : 실행 파일 세그먼트 영역 (fork 시 상속) */
+static bool segment_materialize (struct vma *vma, void *upage);
+static const struct vma_operations segment_vma_ops = {
+	.materialize = segment_materialize,
+	.inherit = true,
+};
+
+/* Project 3. FA : 폴트 난 페이지와 같은 세그먼트의 뒤쪽 페이지들을 한 번의 read로 읽어옴 */
+/* 이웃 페이지들은 미리 읽은 내용을 가지고 바로 claim 함 */
+static bool
+fault_around_segment (struct page *page, off_t ofs, size_t read_bytes) {
+	struct file *file = page->vma->file;
+	struct page *around[FAULT_AROUND_MAX];
+	size_t cnt = 0;
+
+	if (read_bytes == PGSIZE) {																	// 세그먼트의 마지막 페이지가 아닐 때만 이웃을 읽음
+		size_t found = vm_collect_fault_around (page, lazy_load_segment, around, FAULT_AROUND_MAX);
+		while (cnt < found && around[cnt]->vma == page->vma) {									// 같은 영역이면 파일에서도 연속된 위치
+			size_t n = vma_file_bytes_at (page->vma, around[cnt]->va);
+			if (n == 0) break;																	// BSS 등 읽을 내용이 없는 페이지는 제외
+			cnt++;
+			if (n < PGSIZE) break;																// 파일 내용이 끝나는 페이지
+		}
+	}
+
+	uint8_t *buf = cnt > 0 ? palloc_get_multiple (0, cnt + 1) : NULL;							// 이웃이 없거나 메모리가 없으면 한 페이지만 읽음
+	if (buf == NULL)
+		return file_read_at (file, page->frame->kva, read_bytes, ofs) == (off_t) read_bytes;
+
+	off_t total = read_bytes;
+	for (size_t i = 0; i < cnt; i++)
+		total += vma_file_bytes_at (page->vma, around[i]->va);
+
+	if (file_read_at (file, buf, total, ofs) != total) {										// 한 번의 큰 read
+		palloc_free_multiple (buf, cnt + 1);
+		return false;
+	}
+	memcpy (page->frame->kva, buf, read_bytes);
+
+	for (size_t i = 0; i < cnt; i++) {
+		around[i]->uninit.aux = buf + (i + 1) * PGSIZE;
+		if (!vm_claim_page (around[i]->va))
+			around[i]->uninit.aux = NULL;														// 실패 시 다음 폴트에서 직접 읽음
+	}
+	palloc_free_multiple (buf, cnt + 1);
+	return true;
+}
+
 /* Project 3. AP : VM 및 Lazy Load를 위한 lazy load segment 함수 구현 */
+/* Project 3. SPT : 파일 위치와 읽을 길이는 영역 정보로부터 계산. AUX는 fault-around로 미리 읽어 둔 내용 (없으면 NULL) */
 static bool
 lazy_load_segment (struct page *page, void *aux) {
 	/* TODO: Load the segment from the file */														// 파일로부터 세그먼트 로드
 	/* TODO: This called when the first page fault occurs on address VA. */							// VA에서 첫 페이지 폴트 발생 시 호출
 	/* TODO: VA is available when calling this function. */											// 즉, VA는 존재할 수 밖에 없음
 
-	struct load_info* li = (struct load_info *) aux;												// 읽어야 할 파일 정보 가져오기
 	if (page == NULL)  return false;																// 페이지가 NULL 이라면 false 리턴
-	ASSERT(li->page_read_bytes <= PGSIZE);															// 읽어야 할 바이트 수는 항상 PGSIZE 이하
-	ASSERT(li-> page_zero_bytes <= PGSIZE);
-
-	if (li->page_read_bytes > 0) {																	// 읽어야 할 바이트 수가 있다면
-		file_seek (li->file, li->ofs);																// file 내 offset 찾기
-		if (file_read (li->file, page->va, li->page_read_bytes) != (off_t)li->page_read_bytes) {	// 실제로 읽은 바이트 길이와 읽어야 할 바이트 길이 체크
-			vm_dealloc_page (page);																	// 같지 않다면 페이지 할당 반환, 파일 정보 해제 후 false 리턴
-			free (li);
+	struct vma *vma = page->vma;
+	uint8_t *kva = page->frame->kva;																// Project 3. ZP : 읽기 전용 세그먼트도 채울 수 있도록 커널 주소로 씀 (CR0.WP)
+	off_t ofs = vma->ofs + ((uint8_t *) page->va - (uint8_t *) vma->start);						// 읽는 위치
+	size_t read_bytes = vma_file_bytes_at (vma, page->va);											// 읽어야 할 바이트 수 (항상 PGSIZE 이하)
+
+	if (aux != NULL) {																				// Project 3. FA : fault-around로 이미 읽어 둔 경우 복사만 진행
+		memcpy (kva, aux, read_bytes);
+	} else if (read_bytes > 0) {																	// 읽어야 할 바이트 수가 있다면
+		if (!fault_around_segment (page, ofs, read_bytes))											// 이웃 페이지와 함께 읽고, 실제로 읽은 바이트 길이 체크
 			return false;
-		}
 	}
-	memset (page->va+li->page_read_bytes, 0, li->page_zero_bytes);									// 문제 없다면 memset 진행 (dst, value, size)
-	file_close (li -> file);																		// memset 후 파일 닫기 및 파일 정보 해제
-	free (li);
+	memset (kva + read_bytes, 0, PGSIZE - read_bytes);											// 문제 없다면 memset 진행 (dst, value, size)
 	return true;
 }
 
+/* Project 3. VMA : 세그먼트 영역의 UPAGE에 처음 접근할 때 페이지 생성 */
+/* Project 3. SPT : 파일에서 읽을 바이트 수 등은 폴트 시 영역 정보로부터 계산하므로 페이지별 정보 할당 없음 */
+static bool
+segment_materialize (struct vma *vma, void *upage) {
+	size_t page_read_bytes = vma_file_bytes_at (vma, upage);
+
+	/* Project 3. ZP : 파일에서 읽을 내용이 없는 페이지 (BSS)는 zero-fill 표시 */
+	/* Project 3. ST : 읽기 전용 페이지 (text)는 같은 실행 파일을 실행 중인 프로세스와 공유 */
+	enum vm_type type = VM_ANON;
+	vm_initializer *init = lazy_load_segment;
+	if (page_read_bytes == 0) {
+		type = VM_ANON | VM_ZERO_FILL;
+	} else if (!vma->writable) {
+		type = VM_FILE | VM_SHARED_TEXT;
+		init = NULL;														// 내용은 text_swap_in에서 읽음
+	}
+
+	return vm_alloc_page_with_initializer (type, upage, vma->writable, init, NULL);
+}
+
 /* Project 3. AP : VM을 위한 load segment 함수 구현 */
 /* Loads a segment starting at offset OFS in FILE at address
  * UPAGE.  In total, READ_BYTES + ZERO_BYTES bytes of virtual
@@ -945,33 +1083,31 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
 	ASSERT (pg_ofs (upage) == 0);
 	ASSERT (ofs % PGSIZE == 0);
 
-	off_t read_ofs = ofs; 														// 읽는 위치에 대한 정보
-	while (read_bytes > 0 || zero_bytes > 0) {
-		/* Do calculate how to fill this page.
-		 * We will read PAGE_READ_BYTES bytes from FILE
-		 * and zero the final PAGE_ZERO_BYTES bytes. */
-		size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
-		size_t page_zero_bytes = PGSIZE - page_read_bytes;
-
-		/* TODO: Set up aux to pass information to the lazy_load_segment. */
-		struct load_info *aux = malloc(sizeof(struct load_info));				// 로드 되는 파일에 대한 정보 및 읽기 위해 할당
-		aux->file = file_reopen(file);											// file 다시 오픈
-		aux->ofs = read_ofs;													// 읽는 위치
-		aux->page_read_bytes = page_read_bytes;									// 읽어야 할 바이트 수
-		aux->page_zero_bytes = page_zero_bytes;
+	/* Project 3. VMA : 페이지마다 정보를 만들지 않고 세그먼트 전체를 하나의 영역으로 등록 */
+	/* 각 페이지는 폴트가 났을 때 segment_materialize에서 생성 */
+	struct vma *vma = malloc (sizeof (struct vma));
+	if (vma == NULL)
+		return false;
 
-		if (!vm_alloc_page_with_initializer (VM_ANON, upage,					// 초기화 실패 했다면 aux free하고 false 리턴
-					writable, lazy_load_segment, aux)) {
-			free (aux);
-			return false;
-		}
-			
-		/* Advance. */
-		read_bytes -= page_read_bytes;
-		zero_bytes -= page_zero_bytes;
-		upage += PGSIZE;
-		read_ofs += PGSIZE;
+	vma->start = upage;
+	vma->end = upage + read_bytes + zero_bytes;
+	vma->file = file_reopen (file);
+	vma->ofs = ofs;
+	vma->file_bytes = read_bytes;
+	vma->writable = writable;
+	vma->ops = &segment_vma_ops;
+	vma->advice = MADV_NORMAL;
+
+	if (vma->file == NULL || !vma_insert (&thread_current ()->spt.vmas, vma)) {	// 다른 세그먼트와 겹치는 경우 실패
+		file_close (vma->file);
+		free (vma);
+		return false;
 	}
+
+	/* Project 3. HEAP : 힙은 가장 뒤에 있는 세그먼트 바로 뒤에서 시작 */
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	if (vma->end > spt->heap_start)
+		spt->heap_start = spt->brk = vma->end;
 	return true;
 }
 
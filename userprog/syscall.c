@@ -16,10 +16,12 @@
 /* Proj 2-4. file descriptor */
 #include "filesys/filesys.h"
 #include "filesys/file.h"
+#include "filesys/inode.h"
 #include <list.h>
 
 /* Project 3. check adddress, writable 수정에 따른 헤더 추가 */
 #include "vm/file.h"
+#include "vm/rss.h"					// Project 3. RSS : vm_rss_set_limit
 
 /* Proj 2-7. Extra */
 /* stdin, stdout 상수 선언 */
@@ -36,6 +38,7 @@ int write(int fd, const void *buffer, unsigned size);
 tid_t fork(const char *thread_name, struct intr_frame *f);
 int wait(tid_t child_tid);
 int exec(char *file_name);
+tid_t spawn (const char *cmd_line);
 void check_address(uaddr);
 
 /* Project 3. check adddress, writable 수정에 따른 선언 추가 */
@@ -57,6 +60,23 @@ int dup2(int oldfd, int newfd);
 static void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 static void munmap (void* addr);
 
+/* Project 3. MADV : madvise 함수 선언 */
+static int madvise (void *addr, size_t length, int advice);
+
+/* Project 3. MSYNC : msync 함수 선언 */
+static int msync (void *addr, size_t length);
+
+/* Project 3. HEAP : sbrk 함수 선언 */
+static void *sbrk (intptr_t increment);
+
+/* Project 3. RSS : memstat, set_rss_limit 함수 선언 */
+static int memstat (struct memstat *ms);
+static int set_rss_limit (size_t pages);
+
+/* Project 4. DALLOC : fallocate 함수 선언 */
+static int fallocate (int fd, off_t offset, off_t length);
+static void inspect_file_extents (struct intr_frame *f);
+
 int add_file_to_fdt(struct file *file);
 static struct file *find_file_by_fd(int fd);
 void remove_file_from_fdt(int fd);
@@ -88,6 +108,23 @@ syscall_init (void) {
 
 	/* Proj 2-4. file descriptor - race condition을 막기 위한 장치 */
 	lock_init(&filesys_lock);
+
+	/* Project 4. DALLOC : 파일 단편화 확인용
+	 * Tool for testing file fragmentation. Calling inspect_file_extents via int 0x47.
+	 * Input:
+	 *   @RAX - File descriptor to inspect
+	 * Output:
+	 *   @RAX - Number of contiguous runs of the file's data on disk, -1 if FD is invalid. */
+	intr_register_int (0x47, 3, INTR_ON, inspect_file_extents, "Inspect File Extents");
+}
+
+/* Project 4. DALLOC : fd 파일이 디스크에서 나뉜 연속 구간 수 (FAT를 읽으므로 인터럽트를 켠 채 실행) */
+static void
+inspect_file_extents (struct intr_frame *f) {
+	lock_acquire (&filesys_lock);
+	struct file *fileobj = find_file_by_fd (f->R.rax);
+	f->R.rax = (uintptr_t) fileobj > 2 ? inode_extent_count (file_get_inode (fileobj)) : (uint64_t) -1;
+	lock_release (&filesys_lock);
 }
 
 /* The main system call interface */
@@ -98,6 +135,7 @@ syscall_handler (struct intr_frame *f) {
 #ifdef VM
 	struct thread* curr = thread_current ();
 	curr->saving_rsp = f->rsp;
+	vm_oom_check ();						// Project 3. OOM : 종료 대상으로 선택되었다면 여기서 종료
 #endif
 	
 	switch (f->R.rax)
@@ -115,6 +153,9 @@ syscall_handler (struct intr_frame *f) {
 		/* exec 함수를 조금 다듬기 - 특별한 이유 없음 */
 		f->R.rax = exec(f->R.rdi);
 		break;
+	case SYS_SPAWN:
+		f->R.rax = spawn ((const char *) f->R.rdi);
+		break;
 	case SYS_WAIT:
 		f->R.rax = wait(f->R.rdi);
 		break;
@@ -156,11 +197,33 @@ syscall_handler (struct intr_frame *f) {
 	case SYS_MUNMAP:
 		munmap (f->R.rdi);
 		break;
+	case SYS_MADVISE:
+		f->R.rax = madvise ((void *) f->R.rdi, (size_t) f->R.rsi, (int) f->R.rdx);
+		break;
+	case SYS_MSYNC:
+		f->R.rax = msync ((void *) f->R.rdi, (size_t) f->R.rsi);
+		break;
+	case SYS_SBRK:
+		f->R.rax = (uint64_t) sbrk ((intptr_t) f->R.rdi);
+		break;
+	case SYS_MEMSTAT:
+		f->R.rax = memstat ((struct memstat *) f->R.rdi);
+		break;
+	case SYS_SET_RSS_LIMIT:
+		f->R.rax = set_rss_limit ((size_t) f->R.rdi);
+		break;
+	case SYS_FALLOCATE:
+		f->R.rax = fallocate (f->R.rdi, (off_t) f->R.rsi, (off_t) f->R.rdx);
+		break;
 
 	default:
 		exit(-1);
 		break;
 	}
+
+#ifdef VM
+	vm_oom_check ();						// Project 3. OOM : 시스템 콜 도중 선택되었다면 사용자 모드로 돌아가기 전에 종료
+#endif
 	
 	// thread_exit 함수를 호출하면 시스템 콜 한번 호출 후 스레드 종료
 	// 따라서 thread_exit을 주석 처리하고 필요한 경우 SYS_EXIT 시스템 콜 사용
@@ -260,6 +323,13 @@ int exec(char *file_name)
 	NOT_REACHED();
 	return 0;
 }
+/* Project 3. SPAWN : fork + exec를 한 번에 진행 (부모의 주소 공간을 복사하지 않음) */
+/* 성공 시 자식의 pid, 실패 시 -1 리턴 */
+tid_t spawn (const char *cmd_line)
+{
+	check_address (cmd_line);
+	return process_spawn (cmd_line);
+}
 
 
 
@@ -551,8 +621,8 @@ void remove_file_from_fdt(int fd)
 /*
  * addr : 할당한 가상 주소
  * length : 할당할 파일의 길이
- * fd : 파일
- * writable : 메모리 쓰기 가능 여부
+ * fd : 파일 (어나니머스 영역은 -1)
+ * writable : 메모리 쓰기 가능 여부 (MAP_ANONYMOUS, MAP_POPULATE 플래그를 함께 OR 할 수 있음)
  * offset : 파일 내 할당 시작 위치
  */
 static void *
@@ -567,18 +637,100 @@ mmap (void *addr, size_t length, int writable, int fd, off_t offset){
 	if (offset % PGSIZE != 0) return NULL;											// offset은 page-aligned 되어 있어야 함
 	if ((uint64_t)addr + length == 0) return NULL;									// addr와 length 둘 다 0이면 안됨 (?)
 	if (!is_user_vaddr((uint64_t)addr + length)) return NULL;						// addr와 length의 합이 사용자 영역에 있어야 함
-	for (uint64_t i = (uint64_t) addr; i < (uint64_t) addr + length; i += PGSIZE){
-		if (spt_find_page (&thread_current()->spt, (void *)i)!=NULL) return NULL;	// spt에서 할당된 페이지를 찾지 못하면 안됨
-	}
 
-	struct file *target = process_get_file(fd);										// fd 인자를 기반으로 파일 탐색 시작
-	if (target == NULL) return NULL;												// 파일 탐색 실패 시 NULL 리턴
-	
+	/* Project 3. VMA : 다른 영역 (코드, 데이터, mmap) 또는 스택 영역과 겹치면 안됨 */
+	if (vma_overlaps (&thread_current()->spt.vmas, addr, (uint8_t *) addr + length)) return NULL;
+	if ((uint64_t) addr + length > USER_STACK - STACK_LIMIT) return NULL;
+
+	/* Project 3. POPULATE : WRITABLE 인자에 함께 들어온 플래그 분리 */
+	int flags = writable & (MAP_ANONYMOUS | MAP_POPULATE);
+	writable &= ~(MAP_ANONYMOUS | MAP_POPULATE);
 
-	return do_mmap(addr, length, writable, target, offset);							// do_mmap 호출!
+	struct file *target = NULL;														// 어나니머스 영역은 파일 없음
+	if (fd == -1 || (flags & MAP_ANONYMOUS)) {
+		if (fd != -1) return NULL;													// 어나니머스 영역은 fd가 -1이어야 함
+	} else {
+		target = process_get_file(fd);												// fd 인자를 기반으로 파일 탐색 시작
+		if (target == NULL) return NULL;											// 파일 탐색 실패 시 NULL 리턴
+	}
+
+	void *map = do_mmap(addr, length, writable, target, offset);					// do_mmap 호출!
+	if (map != NULL && (flags & MAP_POPULATE))
+		vm_populate (map, length);													// 첫 접근 시 폴트가 나지 않도록 미리 로드
+	return map;
 }
 
 static void
 munmap (void* addr){
 	do_munmap(addr);																// 맵핑 정보 해제
-}
\ No newline at end of file
+}
+
+/* Project 3. MADV : 사용자 프로그램이 알려 준 메모리 접근 패턴 반영. 성공 시 0, 실패 시 -1 리턴 */
+static int
+madvise (void *addr, size_t length, int advice) {
+	if (addr == NULL || pg_ofs (addr) != 0 || length == 0) return -1;				// 주소는 page-aligned 되어 있어야 함
+	if ((uint64_t) addr + length < (uint64_t) addr) return -1;						// 오버플로우 방지
+	if (!is_user_vaddr (addr) || !is_user_vaddr ((uint64_t) addr + length - 1)) return -1;	// 사용자 영역이어야 함
+	if (advice < MADV_NORMAL || advice > MADV_DONTNEED) return -1;
+
+	vm_madvise (addr, length, advice);
+	return 0;
+}
+
+/* Project 3. MSYNC : 범위 내 mmap 영역의 변경 내용을 바로 파일에 반영. 성공 시 0, 실패 시 -1 리턴 */
+static int
+msync (void *addr, size_t length) {
+	if (addr == NULL || pg_ofs (addr) != 0 || length == 0) return -1;				// 주소는 page-aligned 되어 있어야 함
+	if ((uint64_t) addr + length < (uint64_t) addr) return -1;						// 오버플로우 방지
+	if (!is_user_vaddr (addr) || !is_user_vaddr ((uint64_t) addr + length - 1)) return -1;	// 사용자 영역이어야 함
+
+	do_msync (addr, length);
+	return 0;
+}
+
+/* Project 3. HEAP : 힙의 끝을 INCREMENT만큼 옮기고 이전 끝 주소 리턴. 실패 시 (void *) -1 리턴 */
+static void *
+sbrk (intptr_t increment) {
+	return vm_sbrk (increment);
+}
+
+/* Project 3. RSS : 현재 프로세스의 상주, 스왑 페이지 수 등을 MS에 기록. 성공 시 0 리턴 */
+static int
+memstat (struct memstat *ms) {
+	struct memstat *last = (struct memstat *) ((uint8_t *) (ms + 1) - 1);
+	check_address ((const uint64_t *) ms);
+	check_address ((const uint64_t *) last);
+	check_writable_addr ((const uint64_t *) ms);
+	check_writable_addr ((const uint64_t *) last);
+
+	struct thread *curr = thread_current ();
+	struct memstat stat = {
+		.resident = curr->rss,
+		.swapped = curr->swapped,
+		.working_set = curr->wss,
+		.rss_limit = curr->rss_limit,
+	};
+	*ms = stat;
+	return 0;
+}
+
+/* Project 3. RSS : 현재 프로세스의 상주 페이지 수 상한 설정 (0이면 제한 없음). 성공 시 0, 실패 시 -1 리턴 */
+static int
+set_rss_limit (size_t pages) {
+	return vm_rss_set_limit (pages) ? 0 : -1;
+}
+
+
+/* Project 4. DALLOC : fd 파일의 [OFFSET, OFFSET + LENGTH) 범위를 쓸 공간을 미리 할당 (파일 크기는 그대로)
+ * 성공 시 0, 실패 시 -1 리턴 */
+static int
+fallocate (int fd, off_t offset, off_t length) {
+	if (offset < 0 || length <= 0 || offset > OFF_T_MAX - length)
+		return -1;
+
+	lock_acquire (&filesys_lock);
+	struct file *fileobj = find_file_by_fd (fd);
+	bool success = fileobj > 2 && inode_reserve (file_get_inode (fileobj), offset + length);
+	lock_release (&filesys_lock);
+	return success ? 0 : -1;
+}
@@ -13,6 +13,13 @@
 /* Project 3. Swap In/Out : 스왑 아웃에 필요한 헤더 추가 */
 #include "threads/mmu.h"
 
+/* Project 3. ZSWAP : 압축 메모리 캐시 헤더 추가 */
+#include "vm/zswap.h"
+
+/* Project 3. KSM : 병합된 페이지 처리를 위한 헤더 추가 */
+#include "vm/ksm.h"
+#include "vm/rss.h"
+
 /* Project 3. Swap In/Out : 어나니머스 페이지를 위한 스왑 디스크 생성에 필요한 값 정의 */
 /*
  * 정리하자면 DISK_SECTOR_SIZE는 말 그대로 한 섹터의 사이즈
@@ -60,6 +67,8 @@ vm_anon_init (void) {
 
 	swap_table = bitmap_create(max_slot);					// max_slot 기반으로 swap_table 생성
 
+	/* Project 3. ZSWAP : 스왑 디스크 앞단의 압축 캐시 초기화 */
+	zswap_init ();
 }
 
 /* Project 3. AP : anonymous page initializer 구현 */
@@ -76,6 +85,14 @@ anon_initializer (struct page *page, enum vm_type type, void *kva) {	// 인자 (
 	/* Project 3. Swap In/Out : 페이지 별 스왑 슬롯 idx 설정 */
 	anon_page->swap_slot_idx = INVALID_SLOT_IDX;				// 스왑 테이블 저장 시 idx 값 저장
 
+	/* Project 3. ZSWAP : 처음에는 압축 캐시에 없음 */
+	anon_page->zswap = NULL;
+
+	/* Project 3. KSM : 처음에는 병합되지 않은 상태 */
+	anon_page->ksm = NULL;
+	anon_page->ksm_checksum = 0;
+	anon_page->ksm_unstable = false;
+
 	return true;
 }
 
@@ -85,6 +102,13 @@ static bool
 anon_swap_in (struct page *page, void *kva) {
 
 	struct anon_page *anon_page = &page->anon;											// 페이지의 어나니머스 정보 가져오기
+
+	/* Project 3. ZSWAP : 압축 캐시에 있다면 디스크를 거치지 않고 바로 복원 */
+	if (zswap_load (page, kva)) {
+		vm_rss_adjust (anon_page->owner, 0, -1);										// Project 3. RSS : 스왑된 페이지 수 감소
+		return true;
+	}
+
 	if (anon_page->swap_slot_idx == INVALID_SLOT_IDX) return false;						// 할당 받은 슬롯 IDX가 없다면 스왑 아웃 상태 아님으로 false 리턴
 
 	disk_sector_t sec_no;																// 디스크 섹터 넘버 변수
@@ -100,22 +124,20 @@ anon_swap_in (struct page *page, void *kva) {
 	// Clear swap table
 	bitmap_set (swap_table, anon_page->swap_slot_idx, false);							// 스왑 인 후 스왑 테이블에서 off 상태로 전환
 	anon_page->swap_slot_idx = INVALID_SLOT_IDX;										// 스왑 인 후 슬롯 IDX 초기화
+	vm_rss_adjust (anon_page->owner, 0, -1);											// Project 3. RSS : 스왑된 페이지 수 감소
 
+	return true;
 }
 
-/* Project 3. Swap In/Out : 스왑 아웃 진행 */
-/* Swap out the page by writing contents to the swap disk. */
-static bool
-anon_swap_out (struct page *page) {
+/* Project 3. ZSWAP : 페이지 내용(KVA)을 스왑 디스크의 빈 슬롯에 쓰고 PAGE에 슬롯 IDX 기록 */
+/* 가용 스왑 슬롯이 없으면 false 리턴 */
+bool
+anon_swap_to_disk (struct page *page, const void *kva) {
 	struct anon_page *anon_page = &page->anon;
 
 	// Get swap slot index from swap table
 	size_t swap_slot_idx = bitmap_scan_and_flip (swap_table, 0, 1, false);				// 스왑 테이블에서 스왑 슬롯 인덱스 값 가져오기
 	if (swap_slot_idx == BITMAP_ERROR)													// 가용 스왑 슬롯이 없는 경우
-		PANIC("There is no free swap slot!");											// 패닉 발생
-
-	// Copy page frame content to swap_slot
-	if (page == NULL || page->frame == NULL || page->frame->kva == NULL)				// 스왑 아웃 할 페이지의 유효성 검증
 		return false;
 
 	disk_sector_t sec_no;																// 디스크 섹터 넘버 변수
@@ -124,15 +146,36 @@ anon_swap_out (struct page *page) {
 		// convert swap slot index to writing sector number
 		sec_no = (disk_sector_t) (swap_slot_idx * SECTORS_PER_PAGE) + i;				// idx에 섹터 수를 곱하면 위치 반환. 여기서부터 i를 늘리며 읽어오기
 		off_t ofs = i * DISK_SECTOR_SIZE;												// ofs은  DISK_SECTOR_SIZE 만큼 증가 (512, 1024, ... )
-		disk_write (swap_disk, sec_no, page->frame->kva + ofs);							// 위 정보를 기반으로 디스크 쓰기 진행 (스왑 아웃)
+		disk_write (swap_disk, sec_no, kva + ofs);										// 위 정보를 기반으로 디스크 쓰기 진행 (스왑 아웃)
 	}
 
 	anon_page->swap_slot_idx = swap_slot_idx;											// 스왑 아웃 후 슬롯 IDX 업데이트
+	return true;
+}
+
+/* Project 3. Swap In/Out : 스왑 아웃 진행 */
+/* Swap out the page by writing contents to the swap disk. */
+static bool
+anon_swap_out (struct page *page) {
+	// Copy page frame content to swap_slot
+	if (page == NULL || page->frame == NULL || page->frame->kva == NULL)				// 스왑 아웃 할 페이지의 유효성 검증
+		return false;
+
+	struct anon_page *anon_page = &page->anon;
+
+	/* Project 3. KSM : 병합 후보 테이블에서 제거 */
+	ksm_forget (page);
+
+	/* Project 3. ZSWAP : 먼저 압축 캐시에 저장 시도, 실패 시 스왑 디스크로 */
+	if (!zswap_store (page, page->frame->kva)
+			&& !anon_swap_to_disk (page, page->frame->kva))
+		return false;																	// Project 3. OOM : 스왑이 가득 차면 그대로 상주 (호출한 쪽에서 다른 victim 선택)
 
 	// Set "not present" to page, and clear.
 	pml4_clear_page (anon_page->owner->pml4, page->va);									// PML4에서 페이지 삭제
 	pml4_set_dirty (anon_page->owner->pml4, page->va, false);							// PML4에서 dirty 상태 초기화
 	page->frame = NULL;																	// 물리 메모리 해제에 따른 초기화
+	vm_rss_adjust (anon_page->owner, -1, 1);											// Project 3. RSS : 상주에서 스왑으로
 
 	return true;
 }
@@ -141,15 +184,25 @@ anon_swap_out (struct page *page) {
 static void
 anon_destroy (struct page *page) {
 
+	/* Project 3. KSM : 병합된 페이지라면 공유 프레임에서 빠지기만 함 (pml4_destroy가 공유 프레임을 해제하지 않도록) */
+	ksm_forget (page);
+	if (page->anon.ksm != NULL) {
+		ksm_unmerge (page);
+		return;
+	}
+
 	/* Project 3. AP : Page Cleanup 작업을 위한 코드 */
 	if (page -> frame!= NULL){
-		list_remove (&page->frame->elem);
+		vm_frame_remove (page->frame);
 		free(page->frame);
 	}
 	
 	/* Project 3. Swap In/Out : 삭제하려는 어나니머스 페이지가 swapped 된 케이스인 경우 */
 	else {
 		struct anon_page *anon_page = &page->anon;
+
+		/* Project 3. ZSWAP : 압축 캐시에 있던 페이지라면 엔트리만 해제 */
+		if (zswap_invalidate (page)) return;
 		
 		ASSERT (anon_page->swap_slot_idx != INVALID_SLOT_IDX);							// 스왑 된 케이스가 아니면 안됨
 		bitmap_set (swap_table, anon_page->swap_slot_idx, false);						// 스왑 테이블 초기화
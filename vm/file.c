@@ -1,13 +1,18 @@
 /* file.c: Implementation of memory backed file object (mmaped object). */
 
 #include "vm/vm.h"
+#include "vm/rss.h"
 
 /* Project 3. MMF에 따른 헤더 추가 */
 #include "threads/vaddr.h"
 #include "vm/file.h"
 #include <string.h>
+#include <stdlib.h>
 #include "threads/malloc.h"
 #include "threads/mmu.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
 
 static bool file_backed_swap_in (struct page *page, void *kva);
 static bool file_backed_swap_out (struct page *page);
@@ -21,20 +26,24 @@ static const struct page_operations file_ops = {
 	.type = VM_FILE,
 };
 
-/* Project 3. MMF : mmap 기록을 mmap_file_info에 저장 후 리스트로 관리 */
-static struct list mmap_file_list;
+/* Project 3. MSYNC : 메모리에 올라와 있는 파일 페이지 리스트 (flusher가 순회)
+ * 리스트와 write back 중인 페이지를 보호하기 위해 flush_lock 사용 */
+static struct list flush_list;
+static struct lock flush_lock;
+static struct page *flush_pages[FLUSH_BATCH];	// 정렬을 위해 모아 둔 dirty 페이지 (flush_lock 필요)
+static uint8_t *flush_buf;						// 연속된 페이지를 합쳐 쓰기 위한 버퍼 (flush_lock 필요)
 
-struct mmap_file_info{
-	struct list_elem elem;
-	uint64_t start;				// start addr of final page
-	uint64_t end;
-};
+static void file_flusher (void *aux);
 
-/* Project 3. MMF : mmap_file_info 리스트 초기화 */
 /* The initializer of file vm */
+/* Project 3. MR : mmap 정보는 프로세스별 영역 트리 (spt.vmas)에서 관리하므로 전역 정보 없음 */
 void
 vm_file_init (void) {
-	list_init (&mmap_file_list);
+	/* Project 3. MSYNC : flusher 시작 (버퍼를 못 얻으면 한 페이지씩 씀) */
+	list_init (&flush_list);
+	lock_init (&flush_lock);
+	flush_buf = palloc_get_multiple (0, FLUSH_RUN_MAX);
+	thread_create ("flusher", PRI_DEFAULT, file_flusher, NULL);
 }
 
 /* Project 3. MMF : vm_alloc_page_with_initializer에서 fetch 할 file_backed_initializer 함수 구현 */
@@ -43,15 +52,114 @@ bool
 file_backed_initializer (struct page *page, enum vm_type type, void *kva) {
 
 	/* Set up the handler */
-	struct file* file = ((struct mmap_info*)page ->uninit.aux)->file;		// mmap 할 파일 정보 가져오기
+	struct file* file = page->vma->file;									// Project 3. SPT : 영역의 파일을 함께 사용 (페이지마다 reopen 하지 않음)
 	page->operations = &file_ops;											// 파일 백업 페이지의 operations 정보 삽입하기
 
 	struct file_page *file_page = &page->file;								// 파일 페이지 정보 가져오기
 	file_page -> file = file;												// 파일 페이지 정보 업데이트
+	file_page -> owner = thread_current ();									// Project 3. MSYNC : dirty 비트를 확인할 pml4의 주인
+	file_page -> resident = false;
 	
 	return true;
 }
 
+/* Project 3. MSYNC : PAGE가 메모리에 올라왔으므로 flusher 대상에 추가 */
+static void
+flush_track (struct page *page) {
+	lock_acquire (&flush_lock);
+	list_push_back (&flush_list, &page->file.flush_elem);
+	page->file.resident = true;
+	lock_release (&flush_lock);
+}
+
+/* Project 3. MSYNC : PAGE를 flusher 대상에서 제외 (write back 중이라면 끝날 때까지 대기) */
+static void
+flush_untrack (struct page *page) {
+	lock_acquire (&flush_lock);
+	if (page->file.resident) {
+		list_remove (&page->file.flush_elem);
+		page->file.resident = false;
+	}
+	lock_release (&flush_lock);
+}
+
+/* Project 3. MSYNC : flush_pages 정렬 기준 (같은 파일끼리, 파일 내 위치 순) */
+static int
+flush_compare (const void *a_, const void *b_) {
+	const struct page *a = *(struct page * const *) a_;
+	const struct page *b = *(struct page * const *) b_;
+	struct inode *ia = file_get_inode (a->file.file), *ib = file_get_inode (b->file.file);
+
+	if (ia != ib) return ia < ib ? -1 : 1;
+	if (a->file.ofs != b->file.ofs) return a->file.ofs < b->file.ofs ? -1 : 1;
+	return 0;
+}
+
+/* Project 3. MSYNC : flush_pages에 모인 CNT개의 dirty 페이지를 파일 위치 순으로 write back (flush_lock 필요)
+ * 같은 파일에서 이어지는 페이지들은 버퍼에 모아 한 번의 write로 처리 */
+static void
+flush_run (size_t cnt) {
+	qsort (flush_pages, cnt, sizeof *flush_pages, flush_compare);
+
+	for (size_t i = 0; i < cnt; ) {
+		struct page *first = flush_pages[i];
+		size_t n = 1;
+		if (flush_buf != NULL)
+			while (i + n < cnt && n < FLUSH_RUN_MAX) {
+				struct page *prev = flush_pages[i + n - 1], *next = flush_pages[i + n];
+				if (prev->file.size != PGSIZE												// 중간에 빈 부분이 없어야 함
+						|| file_get_inode (next->file.file) != file_get_inode (first->file.file)
+						|| next->file.ofs != prev->file.ofs + PGSIZE)
+					break;
+				n++;
+			}
+
+		/* 복사 전에 dirty를 지워야 복사 중에 쓰인 내용이 다음 write back에 반영 됨 */
+		off_t bytes = 0;
+		for (size_t j = 0; j < n; j++) {
+			struct page *page = flush_pages[i + j];
+			pml4_set_dirty (page->file.owner->pml4, page->va, false);
+			if (n > 1)
+				memcpy (flush_buf + j * PGSIZE, page->frame->kva, page->file.size);
+			bytes += page->file.size;
+		}
+		file_write_at (first->file.file, n > 1 ? flush_buf : first->frame->kva, bytes, first->file.ofs);
+		i += n;
+	}
+}
+
+/* Project 3. MSYNC : 메모리에 올라와 있는 PAGE가 dirty 라면 flush_pages에 추가 (flush_lock 필요)
+ * 가득 차면 먼저 write back 진행 */
+static void
+flush_collect (struct page *page, size_t *cnt) {
+	if (page->file.size == 0 || !pml4_is_dirty (page->file.owner->pml4, page->va))
+		return;
+
+	flush_pages[(*cnt)++] = page;
+	if (*cnt == FLUSH_BATCH) {
+		flush_run (*cnt);
+		*cnt = 0;
+	}
+}
+
+/* Project 3. MSYNC : 주기적으로 모든 프로세스의 dirty 파일 페이지를 write back 하여
+ * 축출이나 munmap 시에는 쓰기 없이 바로 페이지를 버릴 수 있도록 함 */
+static void
+file_flusher (void *aux UNUSED) {
+	for (;;) {
+		timer_sleep (FLUSH_INTERVAL);
+
+		size_t cnt = 0;
+		lock_acquire (&flush_lock);
+		for (struct list_elem *e = list_begin (&flush_list); e != list_end (&flush_list); e = list_next (e))
+			flush_collect ((struct page *) ((uint8_t *) list_entry (e, struct file_page, flush_elem)
+					- offsetof (struct page, file)), &cnt);
+		if (cnt > 0)
+			flush_run (cnt);
+		lock_release (&flush_lock);
+	}
+}
+
 /* Project 3. Swap In/Out : 파일 백업 페이지를 위한 스왑 인 함수 구현 */
 /* Swap in the page by read contents from the file. */
 static bool
@@ -59,12 +167,12 @@ file_backed_swap_in (struct page *page, void *kva) {
 	struct file_page *file_page = &page->file;								// 페이지의 파일 정보 가져오기
 	if (file_page->file == NULL) return false;								// 파일 정보 없으면 false 리턴
 
-	file_seek (file_page->file, file_page->ofs);							// 파일 위치 찾기
-	off_t read_size = file_read (file_page->file, kva, file_page->size);	// 읽어야 할 사이즈 가져오기
+	off_t read_size = file_read_at (file_page->file, kva, file_page->size, file_page->ofs);	// 읽어야 할 사이즈 가져오기 (파일을 영역의 페이지들이 함께 쓰므로 위치를 바꾸지 않음)
 	if (read_size != file_page->size) return false;							// 사이즈 검증
 	if (read_size < PGSIZE)													// PG 사이즈 보다 작을 경우에만 memset 진행
 		memset (kva + read_size, 0, PGSIZE - read_size);					// 남은 부분은 0으로 세팅
 
+	flush_track (page);														// Project 3. MSYNC : flusher 대상에 추가
 	return true;
 }
 
@@ -73,17 +181,19 @@ file_backed_swap_in (struct page *page, void *kva) {
 static bool
 file_backed_swap_out (struct page *page) {
 	struct file_page *file_page = &page->file;								// 페이지의 파일 정보 가져오기
-	struct thread *curr = thread_current ();								// 현재 진행 중이 스레드의 정보 가져오기
+	uint64_t *pml4 = file_page->owner->pml4;								// Project 3. MSYNC : 축출하는 스레드가 아닌 페이지 주인의 pml4
+
+	flush_untrack (page);													// Project 3. MSYNC : flusher 대상에서 제외
 
-	if (pml4_is_dirty (curr->pml4, page->va)) {								// 해당 페이지의 더티 여부 체크
-		file_seek (file_page->file, file_page->ofs);						// 파일과 시작 위치로 탐색
-		file_write (file_page->file, page->va, file_page->size);			// 쓰기 진행 (스왑 아웃)
-		pml4_set_dirty (curr->pml4, page->va, false);						// 더티 상태 초기화
+	if (pml4_is_dirty (pml4, page->va)) {									// 해당 페이지의 더티 여부 체크 (flusher가 이미 썼다면 clean)
+		file_write_at (file_page->file, page->frame->kva, file_page->size, file_page->ofs);	// 쓰기 진행 (스왑 아웃)
+		pml4_set_dirty (pml4, page->va, false);								// 더티 상태 초기화
 	}
 
 	// Set "not present" to page, and clear.
-	pml4_clear_page (curr->pml4, page->va);									// pm14에서 페이지 삭제
+	pml4_clear_page (pml4, page->va);										// pm14에서 페이지 삭제
 	page->frame = NULL;														// 물리 메모리 해제에 따른 NULL 값 대입
+	vm_rss_adjust (file_page->owner, -1, 0);								// Project 3. RSS : 상주 페이지 수 감소
 
 	return true;
 }
@@ -93,96 +203,196 @@ static void
 file_backed_destroy (struct page *page) {
 		// TODO: On mmap_exit sometimes empty file content
 	struct file_page *file_page = &page->file;
+
+	flush_untrack (page);													// Project 3. MSYNC : flusher 대상에서 제외
+
 	//if dirty, write back to file
-	if (pml4_is_dirty (thread_current() -> pml4, page -> va)){
-		file_seek (file_page->file, file_page->ofs);
-		file_write (file_page->file, page->va, file_page->size);
-	}
-	file_close (file_page->file);
+	if (pml4_is_dirty (thread_current() -> pml4, page -> va))
+		file_write_at (file_page->file, page->va, file_page->size, file_page->ofs);
+	/* Project 3. SPT : 파일은 영역 (VMA)이 소유하므로 닫지 않음 */
 
 	if (page->frame != NULL) {
-		list_remove (&page->frame->elem);
+		vm_frame_remove (page->frame);
 		free (page->frame);
 	}
 }
 
 
+static bool lazy_load_file (struct page* page, void* aux);
+
+/* Project 3. FA : 폴트 난 페이지와 같은 영역의 뒤쪽 페이지들을 한 번의 read로 읽어옴 */
+/* 폴트 난 페이지에 읽어 들인 바이트 수를 리턴 */
+static off_t
+fault_around_file (struct page *page, off_t ofs, size_t read_bytes) {
+	struct file *file = page->vma->file;
+	struct page *around[FAULT_AROUND_MAX];
+	size_t cnt = 0;
+
+	if (read_bytes == PGSIZE) {												// 마지막 페이지가 아닐 때만 이웃을 읽음
+		size_t found = vm_collect_fault_around (page, lazy_load_file, around, FAULT_AROUND_MAX);
+		while (cnt < found && around[cnt]->vma == page->vma) {				// 같은 영역이면 파일에서도 연속된 위치
+			size_t n = vma_file_bytes_at (page->vma, around[cnt]->va);
+			if (n == 0) break;
+			cnt++;
+			if (n < PGSIZE) break;											// 매핑의 마지막 페이지
+		}
+	}
+
+	uint8_t *buf = cnt > 0 ? palloc_get_multiple (0, cnt + 1) : NULL;		// 이웃이 없거나 메모리가 없으면 한 페이지만 읽음
+	if (buf == NULL)
+		return file_read_at (file, page->frame->kva, read_bytes, ofs);
+
+	off_t total = read_bytes;
+	for (size_t i = 0; i < cnt; i++)
+		total += vma_file_bytes_at (page->vma, around[i]->va);
+
+	off_t got = file_read_at (file, buf, total, ofs);						// 한 번의 큰 read
+	off_t size = got < (off_t) read_bytes ? got : (off_t) read_bytes;
+	memcpy (page->frame->kva, buf, size);
+
+	for (size_t i = 0; i < cnt; i++) {										// 이웃 페이지는 미리 읽은 내용으로 바로 claim
+		around[i]->uninit.aux = buf + (i + 1) * PGSIZE;
+		if (!vm_claim_page (around[i]->va))
+			around[i]->uninit.aux = NULL;									// 실패 시 다음 폴트에서 직접 읽음
+	}
+	palloc_free_multiple (buf, cnt + 1);
+	return size;
+}
+
 /* Project 3. MMF : mmap을 위한 lazy load 구현 */
+/* Project 3. SPT : 파일 위치와 길이는 영역 정보로부터 계산. AUX는 fault-around로 미리 읽어 둔 내용 (없으면 NULL) */
+/* Project 3. ZP : 읽기 전용 매핑도 채울 수 있도록 사용자 주소가 아닌 프레임의 커널 주소로 씀 (CR0.WP) */
 static bool
 lazy_load_file (struct page* page, void* aux){
-	struct mmap_info* mi = (struct mmap_info*) aux;							// mmap 할 정보 가져오기
-
-	file_seek (mi->file, mi->offset);										// 파일의 current 포지션은 offset 포지션으로 변경
-	page->file.size = file_read (mi->file, page->va, mi->read_bytes);		// 페이지 정보 업데이트 (file_read을 통해 읽은 크기)
-	page->file.ofs = mi->offset;											// 페이지 정보 업데이트 (오프셋)
+	struct vma *vma = page->vma;
+	uint8_t *kva = page->frame->kva;
+	off_t ofs = vma->ofs + ((uint8_t *) page->va - (uint8_t *) vma->start);
+	size_t read_bytes = vma_file_bytes_at (vma, page->va);
+
+	/* Project 3. FA : fault-around로 이미 읽어 둔 경우 복사만 진행 (파일 끝을 넘는 부분은 제외) */
+	if (aux != NULL) {
+		off_t left = file_length (vma->file) - ofs;
+		page->file.size = left <= 0 ? 0 : (left < (off_t) read_bytes ? left : (off_t) read_bytes);
+		memcpy (kva, aux, page->file.size);
+	} else
+		page->file.size = fault_around_file (page, ofs, read_bytes);		// 페이지 정보 업데이트 (읽은 크기)
+	page->file.ofs = ofs;													// 페이지 정보 업데이트 (오프셋)
 
 	if (page->file.size != PGSIZE){											// page-aligned 되어 있어야 함
-		memset (page->va+page->file.size, 0, PGSIZE-page->file.size);		// page-aligned 안되어 있으면 나머지는 0으로 세팅
+		memset (kva + page->file.size, 0, PGSIZE-page->file.size);		// page-aligned 안되어 있으면 나머지는 0으로 세팅
 	}
 
 	pml4_set_dirty(thread_current()->pml4, page->va, false);				// dirty를 false 상태로 세팅
-	free(mi);																// mi 해제
+	flush_track (page);														// Project 3. MSYNC : flusher 대상에 추가
 
 	return true;
 }
 
+/* Project 3. VMA : mmap 영역의 UPAGE에 처음 접근할 때 페이지 생성 */
+static bool
+mmap_materialize (struct vma *vma, void *upage) {
+	/* Project 3. SPT : 파일, 오프셋, 길이는 lazy_load_file이 영역 정보로부터 계산하므로 페이지별 정보 할당 없음 */
+	return vm_alloc_page_with_initializer (VM_FILE, upage, vma->writable, lazy_load_file, NULL);
+}
+
+/* Project 3. VMA : mmap 영역 (fork 시 상속하지 않음) */
+static const struct vma_operations mmap_vma_ops = {
+	.materialize = mmap_materialize,
+	.inherit = false,
+};
+
+/* Project 3. POPULATE : 어나니머스 mmap 영역의 UPAGE에 처음 접근할 때 0으로 채워질 페이지 생성 */
+static bool
+anon_mmap_materialize (struct vma *vma, void *upage) {
+	return vm_alloc_page (VM_ANON | VM_ZERO_FILL, upage, vma->writable);
+}
+
+/* Project 3. POPULATE : 어나니머스 mmap 영역 (파일과 무관하므로 fork 시 자식에게 복사) */
+static const struct vma_operations anon_mmap_vma_ops = {
+	.materialize = anon_mmap_materialize,
+	.inherit = true,
+};
+
 /* Project 3. MMF : mmap 시스템 콜에서 호출 */
 /* Do the mmap */
+/* Project 3. VMA : 페이지를 만들지 않고 영역만 등록하므로 길이와 상관없이 O(log n) */
+/* Project 3. POPULATE : FILE이 NULL이면 어나니머스 영역 */
 void *
 do_mmap (void *addr, size_t length, int writable,
 		struct file *file, off_t offset) {
-	
-	off_t ofs;															// 오프셋 정보
-	uint64_t read_bytes;												// 읽어야 할 바이트 수 정보
-
-	for (uint64_t i = 0; i < length; i += PGSIZE){						// 길이를 PGSIZE 단위로 나누어 작업 시작 (page-aligned)
 
-		struct mmap_info* mi = malloc (sizeof (struct mmap_info));		// mmap 할 정보 가져오기
-
-		ofs = offset + i;												// offset에서 page 단위 만큼 더함 (i는 pgsize의 배수)
-		read_bytes = length - i >= PGSIZE ? PGSIZE : length - i;		// PGSIZE 기준으로 자르기 (길면 PGSIZE, 짧으면 length 만큼)
-
-		mi->file = file_reopen (file);									// 개별적이고 독립적인 참조를 위해 reopen 함수 사용
-		mi->offset = ofs;												// 변경된 오프셋 정보 반영
-		mi->read_bytes = read_bytes;									// 변경된 읽어야 할 바이트 수 정보 반영
-
-		vm_alloc_page_with_initializer (VM_FILE, (void*) ((uint64_t) addr + i), writable, lazy_load_file, (void*) mi);	// lazy_load_file 기반으로 초기화 진행
+	struct vma *vma = malloc (sizeof (struct vma));
+	if (vma == NULL)
+		return NULL;
+
+	vma->start = addr;
+	vma->end = pg_round_up ((uint8_t *) addr + length);
+	vma->file = file != NULL ? file_reopen (file) : NULL;
+	vma->ofs = file != NULL ? offset : 0;
+	vma->file_bytes = file != NULL ? length : 0;
+	vma->writable = writable;
+	vma->ops = file != NULL ? &mmap_vma_ops : &anon_mmap_vma_ops;
+	vma->advice = MADV_NORMAL;
+
+	if ((file != NULL && vma->file == NULL) || !vma_insert (&thread_current ()->spt.vmas, vma)) {
+		file_close (vma->file);
+		free (vma);
+		return NULL;
 	}
 
-	struct mmap_file_info* mfi = malloc (sizeof (struct mmap_file_info));	// mmap 파일 정보 저장을 위한 메모리 할당
-	mfi->start = (uint64_t) addr;											// start 정보 입력
-	mfi->end = (uint64_t) pg_round_down((uint64_t) addr + length -1);		// end 정보 입력
-	
-	list_push_back(&mmap_file_list, &mfi->elem);							// mmap 파일 리스트에 추가
-
 	return addr;
 
 }
 
 /* Project 3. MMF : munmap 시스템 콜에서 호출 */
 /* Do the munmap */
+/* Project 3. MR : 프로세스별 영역 트리에서 O(log n)으로 찾고, 실제로 만들어진 페이지만 정리 */
 void
 do_munmap (void *addr) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
 
-	//traverse mmap_file_list and find appropriate set, and destroy all
-	if (list_empty (&mmap_file_list)) return;		// mmap 파일 리스트가 비어 있다면 munmap 할게 없기 때문에 단순 리턴
+	struct vma *vma = vma_find (&spt->vmas, addr);
+	if (vma == NULL || vma->start != addr
+			|| (vma->ops != &mmap_vma_ops && vma->ops != &anon_mmap_vma_ops))	// mmap으로 만든 영역의 시작 주소여야 함
+		return;
 
-	for (struct list_elem* i = list_front (&mmap_file_list); i != list_end (&mmap_file_list); i = list_next (i))
-	{
-		struct mmap_file_info* mfi = list_entry (i, struct mmap_file_info, elem);			// 리스트 돌며 mmap 파일 정보 가져오기
+	vma_remove (&spt->vmas, vma);											// 1) 영역을 먼저 제거하여 새 페이지가 만들어지지 않도록 함
 
-		if (mfi -> start == (uint64_t) addr){												// 만약 start가 addr와 같다면? 해제 시작
+	while (!list_empty (&vma->pages)) {										// 2) 폴트로 만들어진 페이지만 SPT에서 삭제 (dirty면 write back)
+		struct page *page = list_entry (list_front (&vma->pages), struct page, vma_elem);
+		spt_remove_page (spt, page);
+	}
 
-			/* 1) SPT에서 해당되는 페이지 찾은 후 삭제 */
-			for (uint64_t j = (uint64_t)addr; j<= mfi->end; j += PGSIZE){					// end 만큼 PGSIZE 단위로 돌기
-				struct page* page = spt_find_page(&thread_current()->spt, (void *)j);		// spt 검색해서 page 정보 가져오기
-				spt_remove_page(&thread_current()->spt, page);								// remove 진행 (SPT에서 페이지 삭제)
-			}
+	file_close (vma->file);													// 3) 영역 정보 해제
+	free (vma);
+}
 
-			list_remove(&mfi->elem);														// 2) mmap 파일 관리 목록에서 삭제
-			free(mfi);																		// 3) mmap 파일 관리 정보 해제
-			return;
+/* Project 3. MSYNC : msync 시스템 콜에서 호출
+ * [ADDR, ADDR + LENGTH)에 걸친 mmap 영역의 dirty 페이지를 바로 write back */
+void
+do_msync (void *addr, size_t length) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	uint8_t *end = (uint8_t *) addr + length;
+	size_t cnt = 0;
+
+	lock_acquire (&flush_lock);
+	for (uint8_t *va = addr; va < end; ) {
+		struct vma *vma = vma_find (&spt->vmas, va);
+		if (vma == NULL) {
+			va += PGSIZE;
+			continue;
 		}
-	}
 
+		if (vma->ops == &mmap_vma_ops)
+			for (struct list_elem *e = list_begin (&vma->pages); e != list_end (&vma->pages); e = list_next (e)) {
+				struct page *page = list_entry (e, struct page, vma_elem);
+				if (page->operations == &file_ops && page->file.resident
+						&& page->va >= (void *) va && page->va < (void *) end)
+					flush_collect (page, &cnt);
+			}
+		va = vma->end;
+	}
+	if (cnt > 0)
+		flush_run (cnt);
+	lock_release (&flush_lock);
 }
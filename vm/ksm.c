@@ -0,0 +1,227 @@
+/* ksm.c: Kernel same-page merging daemon for anonymous memory. */
+
+#include "vm/ksm.h"
+#include <stddef.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Project 3. KSM : 병합된 프레임 테이블 (stable)과 이번 스캔에서 본 병합 후보 테이블 (unstable)
+ * 스캐너와 페이지 주인이 인터럽트를 끈 상태에서만 접근하므로 메모리 할당이 없도록 리스트 배열로 구현 */
+static struct list ksm_stable[KSM_BUCKETS];
+static struct list ksm_unstable[KSM_BUCKETS];
+
+static size_t ksm_pages_shared;		// 병합된 프레임 수
+static size_t ksm_pages_sharing;	// 병합된 프레임을 매핑 중인 페이지 수
+
+static struct ksm_frame *ksm_spare;	// 새 병합 프레임을 만들 때 쓸 미리 할당한 구조체
+
+#define anon_to_page(ANON) \
+	((struct page *) ((uint8_t *) (ANON) - offsetof (struct page, anon)))
+
+static void ksm_daemon (void *aux);
+
+/* Project 3. KSM : 병합으로 아낀 프레임 수 리턴 */
+static void
+inspect_ksm_sharing (struct intr_frame *f) {
+	f->R.rax = ksm_pages_sharing - ksm_pages_shared;
+}
+
+/* Project 3. KSM : 초기화 후 스캐너 스레드 생성
+ * PRI_MIN이면 사용자 프로세스가 실행 중인 동안에는 스케줄되지 않으므로, 다른 데몬처럼 PRI_DEFAULT로 두고
+ * 한 주기에 KSM_PAGES_PER_SCAN개만 확인한 뒤 잠듦
+ * Tool for testing KSM. Calling inspect_ksm_sharing via int 0x45.
+ * Output:
+ *   @RAX - Number of frames saved by merging. */
+void
+ksm_init (void) {
+	for (size_t i = 0; i < KSM_BUCKETS; i++) {
+		list_init (&ksm_stable[i]);
+		list_init (&ksm_unstable[i]);
+	}
+	intr_register_int (0x45, 3, INTR_OFF, inspect_ksm_sharing, "Inspect KSM Pages Sharing");
+	thread_create ("ksmd", PRI_DEFAULT, ksm_daemon, NULL);
+}
+
+/* Project 3. KSM : 병합된 프레임 중 KVA와 내용이 같은 것을 검색 (인터럽트 off) */
+static struct ksm_frame *
+ksm_stable_find (uint32_t checksum, const void *kva) {
+	struct list *bucket = &ksm_stable[checksum % KSM_BUCKETS];
+	for (struct list_elem *e = list_begin (bucket); e != list_end (bucket); e = list_next (e)) {
+		struct ksm_frame *kf = list_entry (e, struct ksm_frame, bucket_elem);
+		if (kf->checksum == checksum && !memcmp (kf->frame.kva, kva, PGSIZE))
+			return kf;
+	}
+	return NULL;
+}
+
+/* Project 3. KSM : 이번 스캔의 후보 중 PAGE와 내용이 같은 페이지 검색 (인터럽트 off) */
+static struct page *
+ksm_unstable_find (struct page *page, uint32_t checksum) {
+	struct list *bucket = &ksm_unstable[checksum % KSM_BUCKETS];
+	for (struct list_elem *e = list_begin (bucket); e != list_end (bucket); e = list_next (e)) {
+		struct page *cand = anon_to_page (list_entry (e, struct anon_page, ksm_elem));
+		if (cand != page && cand->anon.ksm_checksum == checksum
+				&& !memcmp (cand->frame->kva, page->frame->kva, PGSIZE))
+			return cand;
+	}
+	return NULL;
+}
+
+/* Project 3. KSM : PAGE를 병합 프레임 KF에 읽기 전용으로 매핑 (인터럽트 off)
+ * PAGE가 쓰던 프레임 정리는 호출한 쪽에서 진행 */
+static void
+ksm_merge_into (struct page *page, struct ksm_frame *kf) {
+	struct anon_page *anon_page = &page->anon;
+
+	ksm_forget (page);
+	pml4_clear_page (anon_page->owner->pml4, page->va);
+	pml4_set_page (anon_page->owner->pml4, page->va, kf->frame.kva, false);	// 페이지 테이블이 이미 있으므로 할당 없음
+
+	page->frame = &kf->frame;
+	anon_page->ksm = kf;
+	list_push_back (&kf->sharers, &anon_page->ksm_elem);
+	ksm_pages_sharing++;
+}
+
+/* Project 3. KSM : frame_list의 프레임 하나를 확인하고 가능하면 병합 (clock_lock, 인터럽트 off)
+ * 해제해야 할 프레임 구조체와 kva는 FREE_FRAMES, FREE_KVA에 담아 인터럽트를 켠 뒤 해제 */
+static void
+ksm_scan_frame (struct frame *frame, struct frame **free_frames, void **free_kva) {
+	struct page *page = frame->page;
+	if (page == NULL || page->frame != frame || VM_TYPE (page->operations->type) != VM_ANON
+			|| !page->writable || page->anon.ksm != NULL)
+		return;
+
+	uint32_t checksum = hash_bytes (frame->kva, PGSIZE);						// Project 3. SPT : 하위 32비트만 사용
+	if (checksum != page->anon.ksm_checksum) {							// 지난 스캔 이후 바뀐 페이지는 아직 안정적이지 않음
+		ksm_forget (page);
+		page->anon.ksm_checksum = checksum;
+		return;
+	}
+
+	struct ksm_frame *kf = ksm_stable_find (checksum, frame->kva);
+	if (kf == NULL) {
+		struct page *twin = ksm_unstable_find (page, checksum);
+		if (twin == NULL || ksm_spare == NULL) {						// 짝이 없으면 다음 후보를 위해 등록
+			if (!page->anon.ksm_unstable) {
+				list_push_back (&ksm_unstable[checksum % KSM_BUCKETS], &page->anon.ksm_elem);
+				page->anon.ksm_unstable = true;
+			}
+			return;
+		}
+
+		/* 짝이 된 페이지의 프레임을 그대로 병합 프레임으로 사용 */
+		kf = ksm_spare;
+		ksm_spare = NULL;
+		kf->checksum = checksum;
+		kf->frame.kva = twin->frame->kva;
+		kf->frame.page = twin;
+		list_init (&kf->sharers);
+		list_push_back (&ksm_stable[checksum % KSM_BUCKETS], &kf->bucket_elem);
+		ksm_pages_shared++;
+
+		vm_frame_unlink (twin->frame);
+		free_frames[1] = twin->frame;
+		ksm_merge_into (twin, kf);
+	}
+
+	vm_frame_unlink (frame);
+	free_frames[0] = frame;
+	*free_kva = frame->kva;
+	ksm_merge_into (page, kf);
+}
+
+/* Project 3. KSM : 스캔 한 바퀴가 끝나면 후보 테이블 비우기 (인터럽트 off) */
+static void
+ksm_reset_unstable (void) {
+	for (size_t i = 0; i < KSM_BUCKETS; i++)
+		while (!list_empty (&ksm_unstable[i])) {
+			struct anon_page *anon_page = list_entry (list_pop_front (&ksm_unstable[i]),
+					struct anon_page, ksm_elem);
+			anon_page->ksm_unstable = false;
+		}
+}
+
+/* Project 3. KSM : 주기적으로 frame_list를 조금씩 돌며 병합 */
+static void
+ksm_daemon (void *aux UNUSED) {
+	for (;;) {
+		timer_sleep (KSM_SCAN_INTERVAL);
+
+		for (size_t i = 0; i < KSM_PAGES_PER_SCAN; i++) {
+			struct frame *free_frames[2] = { NULL, NULL };
+			void *free_kva = NULL;
+
+			if (ksm_spare == NULL)
+				ksm_spare = malloc (sizeof *ksm_spare);
+
+			/* 축출 중인 스레드가 보고 있는 프레임을 빼지 않도록 clock_lock을 잡고,
+			 * 비교와 읽기 전용 매핑 사이에 페이지 주인이 쓰지 못하도록 인터럽트 off */
+			vm_frame_lock ();
+			enum intr_level old_level = intr_disable ();
+			struct frame *frame = vm_frame_scan_next ();
+			if (frame == NULL)
+				ksm_reset_unstable ();
+			else
+				ksm_scan_frame (frame, free_frames, &free_kva);
+			intr_set_level (old_level);
+			vm_frame_unlock ();
+
+			free (free_frames[0]);
+			free (free_frames[1]);
+			if (free_kva != NULL)
+				palloc_free_page (free_kva);
+			if (frame == NULL)
+				break;
+		}
+	}
+}
+
+/* Project 3. KSM : 병합된 PAGE의 매핑을 해제 (쓰기 시 copy-on-write, 페이지 삭제 시 호출)
+ * 마지막으로 매핑하던 페이지였다면 병합 프레임도 해제 */
+void
+ksm_unmerge (struct page *page) {
+	struct anon_page *anon_page = &page->anon;
+	struct ksm_frame *kf = anon_page->ksm;
+	void *free_kva = NULL;
+
+	ASSERT (kf != NULL);
+
+	enum intr_level old_level = intr_disable ();
+	list_remove (&anon_page->ksm_elem);
+	pml4_clear_page (anon_page->owner->pml4, page->va);
+	page->frame = NULL;
+	anon_page->ksm = NULL;
+	ksm_pages_sharing--;
+
+	if (list_empty (&kf->sharers)) {
+		list_remove (&kf->bucket_elem);
+		ksm_pages_shared--;
+		free_kva = kf->frame.kva;
+	} else if (kf->frame.page == page)
+		kf->frame.page = anon_to_page (list_entry (list_front (&kf->sharers),
+				struct anon_page, ksm_elem));
+	intr_set_level (old_level);
+
+	if (free_kva != NULL) {
+		palloc_free_page (free_kva);
+		free (kf);
+	}
+}
+
+/* Project 3. KSM : PAGE가 병합 후보 테이블에 있다면 제거 (스왑 아웃, 페이지 삭제 시 호출) */
+void
+ksm_forget (struct page *page) {
+	enum intr_level old_level = intr_disable ();
+	if (page->anon.ksm_unstable) {
+		list_remove (&page->anon.ksm_elem);
+		page->anon.ksm_unstable = false;
+	}
+	intr_set_level (old_level);
+}
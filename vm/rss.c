@@ -0,0 +1,189 @@
+/* rss.c: Per-process resident-set accounting, working-set estimation and OOM killing. */
+
+#include "vm/rss.h"
+#include "vm/vm.h"
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/mmu.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "userprog/syscall.h"
+
+/* Project 3. RSS : 새 프로세스의 상주 페이지 수 상한 (0이면 제한 없음, 커널 옵션 -rss=N 으로 변경 가능) */
+size_t vm_rss_default_limit = 0;
+
+static void rss_sampler (void *aux);
+
+/* Project 3. RSS : working set 샘플링 스레드 생성 */
+void
+vm_rss_init (void) {
+	thread_create ("rssd", PRI_MIN, rss_sampler, NULL);
+}
+
+/* Project 3. RSS : T의 상주 페이지 수와 스왑된 페이지 수 갱신
+ * 다른 프로세스가 축출하면서 바꿀 수 있으므로 인터럽트 off */
+void
+vm_rss_adjust (struct thread *t, int resident, int swapped) {
+	enum intr_level old_level = intr_disable ();
+	t->rss += resident;
+	t->swapped += swapped;
+	intr_set_level (old_level);
+}
+
+/* Project 3. RSS : 축출 시 T의 프레임을 얼마나 우선할지 리턴
+ * 2 : 상한을 넘음, 1 : 추정한 working set보다 많이 상주 중, 0 : 그 외 */
+int
+vm_rss_pressure (struct thread *t) {
+	if (t->rss_limit != 0 && t->rss > t->rss_limit)
+		return 2;
+	if (t->rss > t->wss + RSS_WS_SLACK)
+		return 1;
+	return 0;
+}
+
+/* Project 3. RSS : 현재 프로세스의 상한을 PAGES로 설정 (0이면 제한 없음) */
+bool
+vm_rss_set_limit (size_t pages) {
+	if (pages != 0 && pages < RSS_LIMIT_MIN)
+		return false;
+	thread_current ()->rss_limit = pages;
+	return true;
+}
+
+/* Project 3. RSS : 지난 샘플 이후 접근된 프레임을 주인 프로세스에 집계하고 접근 비트 초기화 (인터럽트 off) */
+static void
+rss_sample_frame (struct frame *frame, void *aux UNUSED) {
+	struct page *page = frame->page;
+	struct thread *owner = vm_page_owner (page);
+	if (owner == NULL || owner->pml4 == NULL)
+		return;
+
+	if (pml4_is_accessed (owner->pml4, page->va)) {
+		owner->ws_accessed++;
+		pml4_set_accessed (owner->pml4, page->va, false);
+	}
+}
+
+/* Project 3. RSS : 이번 구간의 접근 수를 working set 추정치에 반영 (이동 평균) */
+static void
+rss_update_wss (struct thread *t, void *aux UNUSED) {
+	t->wss = (t->wss + t->ws_accessed + 1) / 2;
+	t->ws_accessed = 0;
+}
+
+/* Project 3. RSS : 주기적으로 모든 프레임의 접근 비트를 샘플링 */
+static void
+rss_sampler (void *aux UNUSED) {
+	for (;;) {
+		timer_sleep (RSS_SAMPLE_INTERVAL);
+
+		enum intr_level old_level = intr_disable ();
+		vm_frame_foreach (rss_sample_frame, NULL);
+		thread_foreach (rss_update_wss, NULL);
+		intr_set_level (old_level);
+	}
+}
+
+
+/* OOM 대상 선택 결과 */
+struct oom_pick {
+	struct thread *victim;
+	size_t score;
+};
+
+/* Project 3. OOM : 상주 페이지와 스왑된 페이지가 가장 많은 사용자 프로세스 선택 (인터럽트 off) */
+static void
+oom_score (struct thread *t, void *aux) {
+	struct oom_pick *pick = aux;
+	if (t->pml4 == NULL)									// 커널 스레드이거나 이미 메모리를 정리한 프로세스
+		return;
+
+	size_t score = t->rss + t->swapped;
+	if (pick->victim == NULL || score > pick->score) {
+		pick->victim = t;
+		pick->score = score;
+	}
+}
+
+/* Project 3. OOM : TID인 스레드 검색 (인터럽트 off) */
+struct oom_find {
+	tid_t tid;
+	struct thread *t;
+};
+
+static void
+oom_find_tid (struct thread *t, void *aux) {
+	struct oom_find *find = aux;
+	if (t->tid == find->tid)
+		find->t = t;
+}
+
+static struct thread *
+oom_find (tid_t tid) {
+	struct oom_find find = { tid, NULL };
+	thread_foreach (oom_find_tid, &find);
+	return find.t;
+}
+
+/* Project 3. OOM : 프레임을 구할 수 없을 때 호출
+ * 다른 프로세스가 선택되면 종료 표시 후 메모리가 풀릴 때까지 기다렸다가 true 리턴
+ * 현재 프로세스가 선택되거나, 선택된 프로세스가 막혀 있어 OOM_WAIT_TICKS 안에 종료되지 않으면
+ * 현재 프로세스에 종료 표시를 하고 false 리턴. 어떤 락을 잡고 있을지 모르므로 여기서 종료하지 않음
+ * 시스템 콜이 사용자 버퍼를 다루다 들어온 경우 filesys_lock을 잡고 있으므로 기다리는 동안 놓아 줌
+ * (선택된 프로세스가 그 락을 기다리고 있으면 종료 지점까지 갈 수 없음) */
+bool
+vm_oom_kill (void) {
+	struct thread *curr = thread_current ();
+	struct oom_pick pick = { NULL, 0 };
+
+	enum intr_level old_level = intr_disable ();
+	thread_foreach (oom_score, &pick);
+	if (pick.victim != NULL)
+		pick.victim->oom_killed = true;
+	tid_t tid = pick.victim != NULL ? pick.victim->tid : TID_ERROR;
+	intr_set_level (old_level);
+
+	if (pick.victim == NULL || pick.victim == curr) {
+		curr->oom_killed = true;
+		return false;
+	}
+
+	bool relock = lock_held_by_current_thread (&filesys_lock);
+	if (relock)
+		lock_release (&filesys_lock);
+
+	bool released = false;
+	for (int i = 0; i < OOM_WAIT_TICKS && !released; i++) {	// 시스템 콜, 페이지 폴트, 사용자 모드로 돌아가는 인터럽트에서 종료됨
+		timer_sleep (1);
+
+		old_level = intr_disable ();
+		struct thread *t = oom_find (tid);
+		released = t == NULL || t->pml4 == NULL;
+		intr_set_level (old_level);
+	}
+
+	if (relock)
+		lock_acquire (&filesys_lock);
+	if (released)
+		return true;
+
+	old_level = intr_disable ();
+	struct thread *t = oom_find (tid);
+	if (t != NULL)
+		t->oom_killed = false;
+	curr->oom_killed = true;
+	intr_set_level (old_level);
+	return false;
+}
+
+/* Project 3. OOM : 종료 표시된 경우 exit(-1)과 같이 종료. 프레임과 스왑 슬롯은 process_exit에서 해제
+ * 락을 잡고 있지 않은 시점 (시스템 콜 진입/종료, 사용자 모드 폴트, 사용자 모드로 돌아가는 인터럽트)에서만 호출 */
+void
+vm_oom_check (void) {
+	struct thread *curr = thread_current ();
+
+	if (curr->oom_killed) {
+		curr->exit_status = -1;
+		thread_exit ();
+	}
+}
@@ -0,0 +1,199 @@
+/* text.c: Read-only executable text pages shared between processes. */
+
+#include "vm/text.h"
+#include <string.h>
+#include "vm/vm.h"
+#include "vm/rss.h"
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+static bool text_swap_in (struct page *page, void *kva);
+static bool text_swap_out (struct page *page);
+static void text_destroy (struct page *page);
+
+static const struct page_operations text_ops = {
+	.swap_in = text_swap_in,
+	.swap_out = text_swap_out,
+	.destroy = text_destroy,
+	.type = VM_FILE | VM_SHARED_TEXT,
+};
+
+/* Project 3. ST : (inode, ofs)로 공유 프레임을 찾기 위한 해시 테이블과 보호용 lock */
+static struct hash text_table;
+static struct lock text_lock;
+
+static uint64_t
+text_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct text_frame *tf = hash_entry (e, struct text_frame, hash_elem);
+	return hash_bytes (&tf->inode, sizeof tf->inode) ^ hash_int (tf->ofs);
+}
+
+static bool
+text_less (const struct hash_elem *a_, const struct hash_elem *b_, void *aux UNUSED) {
+	const struct text_frame *a = hash_entry (a_, struct text_frame, hash_elem);
+	const struct text_frame *b = hash_entry (b_, struct text_frame, hash_elem);
+
+	if (a->inode != b->inode) return a->inode < b->inode;
+	if (a->ofs != b->ofs) return a->ofs < b->ofs;
+	return a->read_bytes < b->read_bytes;
+}
+
+/* Project 3. ST : 초기화 */
+void
+vm_text_init (void) {
+	hash_init (&text_table, text_hash, text_less, NULL);
+	lock_init (&text_lock);
+}
+
+/* Project 3. ST : PAGE와 같은 내용을 가진 공유 프레임 검색 (text_lock 필요) */
+static struct text_frame *
+text_lookup (struct page *page) {
+	struct text_frame key;
+	key.inode = file_get_inode (page->vma->file);
+	key.ofs = page->text.ofs;
+	key.read_bytes = page->text.read_bytes;
+
+	struct hash_elem *e = hash_find (&text_table, &key.hash_elem);
+	return e != NULL ? hash_entry (e, struct text_frame, hash_elem) : NULL;
+}
+
+/* Project 3. ST : vm_alloc_page_with_initializer에서 fetch 할 initializer
+ * Project 3. SPT : 파일 내 위치와 읽을 바이트 수는 세그먼트 영역 정보로부터 계산 */
+bool
+text_initializer (struct page *page, enum vm_type type UNUSED, void *kva UNUSED) {
+	struct vma *vma = page->vma;
+
+	page->operations = &text_ops;
+
+	struct text_page *text_page = &page->text;
+	text_page->owner = thread_current ();
+	text_page->ofs = vma->ofs + ((uint8_t *) page->va - (uint8_t *) vma->start);
+	text_page->read_bytes = vma_file_bytes_at (vma, page->va);
+	text_page->tf = NULL;
+	return true;
+}
+
+/* Project 3. ST : 다른 프로세스가 이미 올려 둔 같은 text 프레임이 있다면 새 프레임 없이 매핑하고 true 리턴
+ * text 페이지가 아니거나 공유할 프레임이 없으면 false를 리턴하고 호출한 쪽에서 일반적인 claim 진행 */
+bool
+text_attach (struct page *page) {
+	if (page->operations->type == VM_UNINIT) {
+		if (!(page->uninit.type & VM_SHARED_TEXT))
+			return false;
+		page->uninit.page_initializer (page, page->uninit.type, NULL);		// 읽기 전에 text 페이지로 전환
+	} else if (!(page->operations->type & VM_SHARED_TEXT))
+		return false;
+
+	ASSERT (page->frame == NULL);
+
+	lock_acquire (&text_lock);
+	struct text_frame *tf = text_lookup (page);
+	if (tf == NULL
+			|| !pml4_set_page (page->text.owner->pml4, page->va, tf->frame->kva, false)) {
+		lock_release (&text_lock);
+		return false;
+	}
+
+	page->frame = tf->frame;
+	page->text.tf = tf;
+	list_push_back (&tf->sharers, &page->text.sharer_elem);
+	lock_release (&text_lock);
+	return true;
+}
+
+/* Project 3. ST : 실행 파일에서 내용을 읽어 온 뒤 다른 프로세스가 공유할 수 있도록 등록 */
+static bool
+text_swap_in (struct page *page, void *kva) {
+	struct text_page *text_page = &page->text;
+
+	if (file_read_at (page->vma->file, kva, text_page->read_bytes, text_page->ofs)
+			!= (off_t) text_page->read_bytes)
+		return false;
+	memset (kva + text_page->read_bytes, 0, PGSIZE - text_page->read_bytes);
+
+	struct text_frame *tf = malloc (sizeof *tf);
+	if (tf == NULL)
+		return true;														// 공유만 하지 못할 뿐 페이지는 정상
+
+	tf->inode = file_get_inode (page->vma->file);
+	tf->ofs = text_page->ofs;
+	tf->read_bytes = text_page->read_bytes;
+	tf->frame = page->frame;
+	list_init (&tf->sharers);
+
+	lock_acquire (&text_lock);
+	if (hash_insert (&text_table, &tf->hash_elem) == NULL) {				// 읽는 동안 다른 프로세스가 먼저 등록했다면 개인 프레임으로 사용
+		list_push_back (&tf->sharers, &text_page->sharer_elem);
+		text_page->tf = tf;
+		tf = NULL;
+	}
+	lock_release (&text_lock);
+
+	free (tf);
+	return true;
+}
+
+/* Project 3. ST : 파일에서 다시 읽을 수 있으므로 write back 없이 모든 공유 프로세스의 매핑만 해제 */
+static bool
+text_swap_out (struct page *page) {
+	struct text_page *text_page = &page->text;
+
+	lock_acquire (&text_lock);
+	struct text_frame *tf = text_page->tf;
+	if (tf == NULL) {
+		pml4_clear_page (text_page->owner->pml4, page->va);
+		page->frame = NULL;
+		vm_rss_adjust (text_page->owner, -1, 0);							// Project 3. RSS : 상주 페이지 수 감소
+	} else {
+		hash_delete (&text_table, &tf->hash_elem);
+		while (!list_empty (&tf->sharers)) {
+			struct text_page *sharer = list_entry (list_pop_front (&tf->sharers),
+					struct text_page, sharer_elem);
+			struct page *p = (struct page *) ((uint8_t *) sharer - offsetof (struct page, text));
+
+			pml4_clear_page (sharer->owner->pml4, p->va);
+			p->frame = NULL;
+			sharer->tf = NULL;
+			vm_rss_adjust (sharer->owner, -1, 0);								// Project 3. RSS : 공유하던 모든 프로세스의 상주 페이지 수 감소
+		}
+		free (tf);
+	}
+	lock_release (&text_lock);
+	return true;
+}
+
+/* Project 3. ST : text 페이지 삭제. 마지막으로 공유하던 페이지라면 프레임까지 해제
+ * PAGE will be freed by the caller. */
+static void
+text_destroy (struct page *page) {
+	struct text_page *text_page = &page->text;
+	struct frame *frame = page->frame;
+
+	if (frame != NULL) {
+		lock_acquire (&text_lock);
+		struct text_frame *tf = text_page->tf;
+		if (tf == NULL) {														// 공유하지 않는 프레임은 pml4_destroy가 해제
+			vm_frame_remove (frame);
+			free (frame);
+		} else {
+			list_remove (&text_page->sharer_elem);
+			pml4_clear_page (text_page->owner->pml4, page->va);				// 다른 프로세스가 쓰는 프레임을 pml4_destroy가 해제하지 않도록
+
+			if (list_empty (&tf->sharers)) {								// 마지막 사용자라면 프레임 해제
+				hash_delete (&text_table, &tf->hash_elem);
+				vm_frame_remove (frame);
+				palloc_free_page (frame->kva);
+				free (frame);
+				free (tf);
+			} else if (frame->page == page) {								// frame_list에서 대표하던 페이지라면 다른 공유 페이지로 교체
+				struct text_page *next = list_entry (list_front (&tf->sharers),
+						struct text_page, sharer_elem);
+				frame->page = (struct page *) ((uint8_t *) next - offsetof (struct page, text));
+			}
+		}
+		lock_release (&text_lock);
+	}
+}
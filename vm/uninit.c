@@ -11,8 +11,9 @@
 #include "vm/vm.h"
 #include "vm/uninit.h"
 
-/* Project 3. AP : Page Cleanup 작업을 위한 헤더 추가 */
-#include "threads/malloc.h"
+/* Project 3. ZP : zero page 매핑 해제를 위한 헤더 추가 */
+#include "threads/mmu.h"
+
 
 static bool uninit_initialize (struct page *page, void *kva);
 static void uninit_destroy (struct page *page);
@@ -68,8 +69,11 @@ uninit_destroy (struct page *page) {
 	/* TODO: Fill this function.
 	 * TODO: If you don't have anything to do, just return. */
 
-	/* Project 3. AP : Page Cleanup 작업을 위한 코드 */
-	if (page->uninit.aux != NULL) free (page->uninit.aux);
-	
+	/* Project 3. ZP : 공유 zero page에 매핑된 상태라면 매핑 해제 (pml4_destroy가 zero page를 해제하지 않도록) */
+	if (vm_is_zero_mapped (page))
+		pml4_clear_page (thread_current ()->pml4, page->va);
+
+	/* Project 3. SPT : aux는 NULL이거나 fault-around가 잠시 넘겨 준 버퍼이므로 해제할 것이 없음 */
+
 	return;
 }
@@ -16,6 +16,11 @@
 /* Project 3. AP : SPT-REVISIT 작업 진행 */
 #include <string.h>
 
+/* Project 3. KSM : 같은 내용의 어나니머스 페이지 병합 */
+#include "vm/ksm.h"
+#include "vm/rss.h"
+#include "threads/interrupt.h"
+
 /* Project 3. MM : frame_list 선언 */
 static struct list frame_list;
 
@@ -28,6 +33,26 @@ static struct lock clock_lock;
 /* Project 3. Swap In/Out : clock 알고리즘에 따른 대상 정보 */
 static struct list_elem *clock_elem;
 
+/* Project 3. KSM : 병합 스캐너가 다음에 확인할 frame_list 원소 (NULL이면 처음부터, 끝이면 한 바퀴 완료) */
+static struct list_elem *scan_elem;
+
+/* Project 3. FA : fault-around 윈도우 크기 (페이지 단위, 커널 옵션 -fa=N 으로 변경 가능) */
+size_t vm_fault_around_pages = FAULT_AROUND_DEFAULT;
+
+/* Project 3. ZP : 모든 프로세스가 읽기 전용으로 공유하는 zero page */
+static void *zero_page_kva;
+
+/* Project 3. SPT : 현재 프로세스의 SPT (해시 테이블, 페이지, 영역)가 차지하는 바이트 수 리턴 */
+static void
+inspect_spt_bytes (struct intr_frame *f) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct hash *h = spt->page_table;
+
+	f->R.rax = h == NULL ? 0 : sizeof *h + h->bucket_cnt * sizeof (struct list)
+			+ hash_size (h) * sizeof (struct page)
+			+ spt->vmas.cnt * sizeof (struct vma);
+}
+
 /* Initializes the virtual memory subsystem by invoking each subsystem's
  * intialize codes. */
 void
@@ -52,6 +77,27 @@ vm_init (void) {
 
 	/* Project 3. Swap In/Out : 처음에는 당연히 NULL 값 */
 	clock_elem = NULL;
+	scan_elem = NULL;
+
+	/* Project 3. ST : 공유 text 페이지 테이블 초기화 */
+	vm_text_init ();
+
+	/* Project 3. KSM : 병합 스캐너 시작 */
+	ksm_init ();
+
+	/* Project 3. RSS : working set 샘플링 시작 */
+	vm_rss_init ();
+
+	/* Project 3. ZP : 공유 zero page 할당 (해제하지 않음) */
+	zero_page_kva = palloc_get_page (PAL_USER | PAL_ZERO);
+	if (zero_page_kva == NULL)
+		PANIC ("zero page allocation failed");
+
+	/* Project 3. SPT : 페이지 정보가 차지하는 커널 메모리 확인용
+	 * Tool for testing SPT size. Calling inspect_spt_bytes via int 0x46.
+	 * Output:
+	 *   @RAX - Bytes of kernel heap used by the current process's SPT. */
+	intr_register_int (0x46, 3, INTR_OFF, inspect_spt_bytes, "Inspect SPT Bytes");
 }
 
 /* Get the type of the page. This function is useful if you want to know the
@@ -69,9 +115,10 @@ page_get_type (struct page *page) {
 }
 
 /* Helpers */
-static struct frame *vm_get_victim (void);
+static struct page *spt_lookup (struct supplemental_page_table *spt, void *va);
+static struct frame *vm_get_victim (struct thread *only);
 static bool vm_do_claim_page (struct page *page);
-static struct frame *vm_evict_frame (void);
+static struct frame *vm_evict_frame (struct thread *only);
 
 /* Project 3. MM : page_hash, page_less 함수 선언 */
 static uint64_t page_hash (const struct hash_elem *p_, void *aux UNUSED);
@@ -93,7 +140,7 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 	bool writable_aux = writable;
 
 	/* Check wheter the upage is already occupied or not. */
-	if (spt_find_page (spt, upage) == NULL) {							// 전달 받은 va가 spt에 없는 경우에 진행 (처음 생성한 페이지라는 뜻)
+	if (spt_lookup (spt, upage) == NULL) {								// 전달 받은 va가 spt에 없는 경우에 진행 (처음 생성한 페이지라는 뜻)
 		/* TODO: Create the page, fetch the initialier according to the VM type,
 		 * TODO: and then create "uninit" page struct by calling uninit_new. You
 		 * TODO: should modify the field after calling the uninit_new. */
@@ -102,7 +149,10 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 
 		struct page *page = malloc(sizeof(struct page));				// 페이지 구조체 malloc 할당
 
-		if (VM_TYPE(type) == VM_ANON) {
+		if (type & VM_SHARED_TEXT) {
+			/* Project 3. ST : 공유 text 페이지를 위한 initializer fetch */
+			uninit_new (page, upage, init, type, aux, text_initializer);
+		} else if (VM_TYPE(type) == VM_ANON) {
 			uninit_new(page, upage, init, type, aux, anon_initializer);	// initializer fetch (구조체 초기화 작업 진행)
 		} else if (VM_TYPE(type) == VM_FILE) {
 
@@ -112,6 +162,11 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 		
 		page->writable = writable_aux;										// 전달 받은 쓰기 가능 정보 저장하기
 
+		/* Project 3. MR : munmap 시 만들어진 페이지만 정리할 수 있도록 해당 주소의 영역에 연결 */
+		page->vma = vma_find (&spt->vmas, upage);
+		if (page->vma != NULL)
+			list_push_back (&page->vma->pages, &page->vma_elem);
+
 		/* TODO: Insert the page into the spt. */
 		spt_insert_page(spt, page);										// spt에 page 삽입하기
 		return true;													// 모든 작업 완료 시 true 반환
@@ -120,11 +175,9 @@ err:
 	return false;
 }
 
-/* Project 3. MM : spt에서 VA 찾고 페이지 리턴하는 함수 구현 */
-/* Find VA from spt and return page. On error, return NULL. */
-struct page *
-spt_find_page (struct supplemental_page_table *spt UNUSED, void *va UNUSED) {
-	/* TODO: Fill this function. */
+/* Project 3. VMA : SPT의 해시 테이블에서만 VA 검색 (VMA에서 페이지를 만들지 않음) */
+static struct page *
+spt_lookup (struct supplemental_page_table *spt, void *va) {
 	struct page page;
 
 	page.va = pg_round_down(va);											// 가장 가까운 페이지 영역으로 내림
@@ -138,6 +191,21 @@ spt_find_page (struct supplemental_page_table *spt UNUSED, void *va UNUSED) {
 	return result;
 }
 
+/* Project 3. MM : spt에서 VA 찾고 페이지 리턴하는 함수 구현 */
+/* Find VA from spt and return page. On error, return NULL. */
+struct page *
+spt_find_page (struct supplemental_page_table *spt UNUSED, void *va UNUSED) {
+	/* TODO: Fill this function. */
+	struct page *page = spt_lookup (spt, va);
+	if (page != NULL) return page;
+
+	/* Project 3. VMA : 아직 만들어지지 않은 페이지라면 VA를 포함하는 영역에서 생성 */
+	struct vma *vma = vma_find (&spt->vmas, va);
+	if (vma == NULL || !vma->ops->materialize (vma, pg_round_down (va)))
+		return NULL;
+	return spt_lookup (spt, va);
+}
+
 /* Project 3. MM : Page를 spt에 삽입하는 함수 구현 */
 /* Insert PAGE into spt with validation. */
 bool
@@ -149,12 +217,36 @@ spt_insert_page (struct supplemental_page_table *spt UNUSED,
 	return (result == NULL) ? true : false;
 }
 
+/* Project 3. RSS : 현재 프로세스의 PAGE를 삭제하기 전에 상주, 스왑 페이지 수에서 제외 */
+static void
+vm_rss_forget (struct page *page) {
+	bool swapped = page->frame == NULL && VM_TYPE (page->operations->type) == VM_ANON
+			&& (page->anon.swap_slot_idx != INVALID_SLOT_IDX || page->anon.zswap != NULL);
+
+	if (page->frame != NULL || swapped)
+		vm_rss_adjust (thread_current (), page->frame != NULL ? -1 : 0, swapped ? -1 : 0);
+}
+
 void
 spt_remove_page (struct supplemental_page_table *spt, struct page *page) {
 	/* Project 3. MMF : munmap 시 사용 */
+	uint64_t *pml4 = thread_current ()->pml4;
+	void *va = page->va;
+	void *kva = pml4_get_page (pml4, va);										// Project 3. MADV : 삭제 후에도 매핑이 남아 있는지 확인하기 위함
+
 	struct hash_elem* e = hash_delete (spt -> page_table, &page ->hash_elem);  	// hash 테이블로 관리하기 때문에 hash 테이블에서 가져오기
-	if (e != NULL) vm_dealloc_page (page);										// 해시 테이블에 값이 있다면 해당 값 dealloc 진행
-	return true;
+	if (page->vma != NULL) list_remove (&page->vma_elem);						// Project 3. MR : 영역의 페이지 리스트에서 제거
+	if (e != NULL) {
+		vm_rss_forget (page);													// Project 3. RSS : 사용량에서 제외
+		vm_dealloc_page (page);													// 해시 테이블에 값이 있다면 해당 값 dealloc 진행
+	}
+
+	/* Project 3. MADV : 프로세스가 계속 실행되므로 pml4_destroy를 기다리지 않고 매핑과 프레임을 바로 해제
+	 * (공유 프레임은 destroy에서 이미 매핑을 해제했으므로 남아 있는 매핑은 이 페이지만의 프레임) */
+	if (kva != NULL && pml4_get_page (pml4, va) == kva) {
+		pml4_clear_page (pml4, va);
+		palloc_free_page (kva);
+	}
 }
 
 /* Project 3. Swap In/Out : clock 알고리즘에 따라 list를 원형 테이블로 바꾸기 위한 함수 구현 */
@@ -170,17 +262,108 @@ list_next_cycle (struct list *lst, struct list_elem *elem) {
 	return cand_elem;
 }
 
+/* Project 3. KSM : frame_list를 다루는 동안 축출, 프레임 추가/삭제와 겹치지 않도록 clock_lock 획득/해제 */
+void
+vm_frame_lock (void) {
+	lock_acquire (&clock_lock);
+}
+
+void
+vm_frame_unlock (void) {
+	lock_release (&clock_lock);
+}
+
+/* Project 3. KSM : 스캔 커서가 가리키는 프레임을 리턴하고 커서를 다음으로 이동
+ * 한 바퀴를 다 돌았으면 NULL 리턴 (다음 호출은 처음부터). clock_lock을 잡은 상태에서 호출 */
+struct frame *
+vm_frame_scan_next (void) {
+	ASSERT (lock_held_by_current_thread (&clock_lock));
+
+	if (scan_elem == NULL)
+		scan_elem = list_begin (&frame_list);
+	if (scan_elem == list_end (&frame_list)) {
+		scan_elem = NULL;
+		return NULL;
+	}
+
+	struct frame *frame = list_entry (scan_elem, struct frame, elem);
+	scan_elem = list_next (scan_elem);
+	return frame;
+}
+
+/* Project 3. RSS : frame_list의 모든 프레임에 대해 FUNC 호출 (인터럽트 off) */
+void
+vm_frame_foreach (void (*func) (struct frame *, void *), void *aux) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	lock_acquire (&clock_lock);
+	for (struct list_elem *e = list_begin (&frame_list); e != list_end (&frame_list); e = list_next (e))
+		func (list_entry (e, struct frame, elem), aux);
+	lock_release (&clock_lock);
+}
+
+/* Project 3. RSS : PAGE를 매핑한 프로세스 리턴 (초기화 중인 페이지 등 알 수 없으면 NULL) */
+struct thread *
+vm_page_owner (struct page *page) {
+	if (page == NULL)
+		return NULL;
+
+	int type = page->operations->type;
+	if (type & VM_SHARED_TEXT)
+		return page->text.owner;
+	switch (VM_TYPE (type)) {
+		case VM_ANON:
+			return page->anon.owner;
+		case VM_FILE:
+			return page->file.owner;
+		default:
+			return NULL;
+	}
+}
+
+/* Project 3. KSM : FRAME을 frame_list에서 제거 (clock_elem, scan_elem이 가리키고 있었다면 다음으로 이동)
+ * clock_lock을 잡은 상태에서 호출 */
+void
+vm_frame_unlink (struct frame *frame) {
+	ASSERT (lock_held_by_current_thread (&clock_lock));
+
+	if (clock_elem == &frame->elem)
+		clock_elem = list_size (&frame_list) > 1 ? list_next_cycle (&frame_list, clock_elem) : NULL;
+	if (scan_elem == &frame->elem)
+		scan_elem = list_next (scan_elem);
+	list_remove (&frame->elem);
+}
+
+/* Project 3. KSM : FRAME을 frame_list의 clock 바로 앞에 추가 (clock_lock을 잡은 상태에서 호출) */
+static void
+vm_frame_link (struct frame *frame) {
+	ASSERT (lock_held_by_current_thread (&clock_lock));
+
+	if (clock_elem != NULL)
+		list_insert (clock_elem, &frame->elem);
+	else
+		list_push_back (&frame_list, &frame->elem);
+}
+
+/* Project 3. KSM : 페이지 삭제 시 FRAME을 frame_list에서 제거 */
+void
+vm_frame_remove (struct frame *frame) {
+	lock_acquire (&clock_lock);
+	vm_frame_unlink (frame);
+	lock_release (&clock_lock);
+}
+
 /* Project 3. Swap In/Out : clock 알고리즘에 따른 victim 구하는 함수 구현 */
 /* Get the struct frame, that will be evicted. */
+/* Project 3. RSS : ONLY가 NULL이 아니면 해당 프로세스의 프레임 중에서만 선택
+ * 전역 축출 시에는 상한이나 working set을 넘은 프로세스의 프레임을 우선함 */
 static struct frame *
-vm_get_victim (void) {
+vm_get_victim (struct thread *only) {
 
 	struct frame *victim = NULL;
 	/* TODO: The policy for eviction is up to you. */
 	/* Clock Algorithm 선택 - https://kouzie.github.io/operatingsystem/%EA%B0%80%EC%83%81%EB%A9%94%EB%AA%A8%EB%A6%AC/#clock-algorithm */
 
-	struct thread *curr = thread_current ();								// 현재 실행 중인 스레드 정보 가져오기
-
 	lock_acquire (&clock_lock);												// 스레드 간 발생할 수 있는 동기화 및 레이스 이슈 방지
 
 	struct list_elem *vict_elem = clock_elem;								// clock elem 정보 가져오기 (최초에는 NULL인 것임)
@@ -188,19 +371,49 @@ vm_get_victim (void) {
 	if (vict_elem == NULL && !list_empty (&frame_list))						// vict 정보가 없는데 (최초), frame list가 비어있지 않다면
 		vict_elem = list_front (&frame_list);								// list의 첫 번째를 vict_elem으로 가져오기 (해당 elem 기반으로 탐색 시작)
 
-	while (vict_elem != NULL) {												// vict 정보가 있다면,
+	/* 접근 비트를 지우며 한 바퀴 돌면 다음 바퀴에서는 반드시 찾으므로 두 바퀴 이상 돌지 않음 */
+	size_t max_scan = 2 * list_size (&frame_list) + 1;
+	size_t ahead = 0;														// 우선 대상이 아닌 후보를 찾은 뒤 더 살펴본 프레임 수
+	struct list_elem *fallback = NULL;
+
+	for (size_t i = 0; vict_elem != NULL && i < max_scan; i++) {			// vict 정보가 있다면,
 
 		// Check frame accessed
 		victim = list_entry (vict_elem, struct frame, elem);				// frame 리스트에 있는 victim 후보 하나씩 조회하기
+		struct thread *owner = vm_page_owner (victim->page);				// Project 3. RSS : 접근 비트는 페이지 주인의 pml4에서 확인
+
+		if (owner != NULL && owner->pml4 != NULL && (only == NULL || owner == only)) {
+			/* Project 3. MADV : 순차 접근으로 알려진 영역의 페이지는 다시 쓰이지 않으므로 먼저 축출 */
+			if (!pml4_is_accessed (owner->pml4, victim->page->va)			// 최근에 접근한 적이 없는 페이지다?
+					|| (victim->page->vma != NULL && victim->page->vma->advice == MADV_SEQUENTIAL)) {
+				if (only != NULL || vm_rss_pressure (owner) > 0)
+					break; // Found!										// 당첨
+				if (fallback == NULL)
+					fallback = vict_elem;									// 우선 대상이 아니면 조금 더 살펴봄
+			} else
+				pml4_set_accessed (owner->pml4, victim->page->va, false);	// 한번 체크한 친구는 지나갈 때 0으로 다시 바꿔줌
+		}
 
-		if (!pml4_is_accessed (curr->pml4, victim->page->va))				// 최근에 접근한 적이 없는 페이지다?
-			break; // Found!												// 당첨
-		
-		pml4_set_accessed (curr->pml4, victim->page->va, false);			// 한번 체크한 친구는 지나갈 때 0으로 다시 바꿔줌
+		if (fallback != NULL && ahead++ == RSS_SCAN_AHEAD) {
+			vict_elem = fallback;
+			break;
+		}
 		vict_elem = list_next_cycle (&frame_list, vict_elem);				// frame_list의 다음 친구를 vict_elem으로 설정
-	}			
-	
-	clock_elem = list_next_cycle (&frame_list, vict_elem);					// break 시 선택 된 victim은 빠지기 때문에 그 다음 친구를 clock_elem으로 선정 (Tick Clock)
+		victim = NULL;
+	}
+
+	if (victim == NULL && fallback != NULL)
+		vict_elem = fallback;
+	if (vict_elem == NULL || (victim == NULL && fallback == NULL)) {		// Project 3. RSS : 대상 프로세스의 프레임이 없음
+		lock_release (&clock_lock);
+		return NULL;
+	}
+	victim = list_entry (vict_elem, struct frame, elem);
+
+	/* break 시 선택 된 victim은 빠지기 때문에 그 다음 친구를 clock_elem으로 선정 (Tick Clock) */
+	clock_elem = list_next_cycle (&frame_list, vict_elem);
+	if (clock_elem == vict_elem) clock_elem = NULL;							// 마지막 프레임이었다면 처음부터 다시 시작
+	if (scan_elem == vict_elem) scan_elem = list_next (vict_elem);			// Project 3. KSM : 스캔 커서도 다음으로
 	list_remove (vict_elem);												// victim은 리스트에서 삭제
 	
 	lock_release (&clock_lock);												// 락 해제
@@ -213,31 +426,49 @@ vm_get_victim (void) {
 /* Evict one page and return the corresponding frame.
  * Return NULL on error.*/
 static struct frame *
-vm_evict_frame (void) {
-	struct frame *victim UNUSED = vm_get_victim ();							// victim 선정
-
-	/* TODO: swap out the victim and return the evicted frame. */
-	if (victim == NULL) return NULL;										// victim이 선정되지 않았다면 NULL 리턴
-
-	/* Swap out the victim and return the evicted frame. */
-	struct page *page = victim->page;										// victim의 페이지 구조체 가져오기
-	bool swap_done = swap_out (page);										// victim의 페이지 스왑 아웃 시키기
-
-	if (!swap_done) PANIC("Swap is full!\n");								// swap이 안되었다면 꽉 찼다는 뜻임으로 PANIC 발생
+vm_evict_frame (struct thread *only) {
+	for (int try = 0; try < EVICT_RETRY; try++) {
+		struct frame *victim UNUSED = vm_get_victim (only);					// victim 선정
+
+		/* TODO: swap out the victim and return the evicted frame. */
+		if (victim == NULL) return NULL;									// victim이 선정되지 않았다면 NULL 리턴
+
+		/* Swap out the victim and return the evicted frame. */
+		struct page *page = victim->page;									// victim의 페이지 구조체 가져오기
+		bool swap_done = swap_out (page);									// victim의 페이지 스왑 아웃 시키기
+
+		/* Project 3. OOM : 스왑 공간이 없어 내보내지 못했다면 리스트의 맨 뒤 (clock 바로 앞)로 되돌리고
+		 * 다른 프레임 (파일 페이지 등)으로 다시 시도 */
+		if (!swap_done) {
+			lock_acquire (&clock_lock);
+			vm_frame_link (victim);
+			lock_release (&clock_lock);
+			continue;
+		}
 
-	victim->page = NULL;													// victim의 페이지 초기화
-	memset (victim->kva, 0, PGSIZE);										// 해당 페이지의 값 0으로 초기화
+		victim->page = NULL;												// victim의 페이지 초기화
+		memset (victim->kva, 0, PGSIZE);									// 해당 페이지의 값 0으로 초기화
 
-	return victim;															// 축출 완료 및 해당 victim 전달
+		return victim;														// 축출 완료 및 해당 victim 전달
+	}
+	return NULL;															// 스왑이 가득 참
 }
 
 /* Project 3. MM : frame 얻기 위한 함수 구현 */
 /* palloc() and get frame. If there is no available page, evict the page
- * and return it. This always return valid address. That is, if the user pool
- * memory is full, this function evicts the frame to get the available memory
- * space.*/
+ * and return it. That is, if the user pool memory is full, this function
+ * evicts the frame to get the available memory space.
+ * Project 3. OOM : 스왑까지 가득 차 현재 프로세스가 종료 대상이 되면 NULL 리턴 */
 static struct frame *
 vm_get_frame (void) {
+	/* Project 3. RSS : 상한에 도달한 프로세스는 다른 프로세스를 밀어내지 않고 자신의 프레임을 재사용 */
+	struct thread *curr = thread_current ();
+	if (curr->rss_limit != 0 && curr->rss >= curr->rss_limit) {
+		struct frame *own = vm_evict_frame (curr);
+		if (own != NULL)
+			return own;
+	}
+
 	/* TODO: Fill this function. */
 	struct frame *frame = malloc(sizeof(struct frame));
 	frame->kva = palloc_get_page(PAL_USER);
@@ -249,7 +480,21 @@ vm_get_frame (void) {
 
 	if (frame->kva == NULL) {
 	  free(frame);						// 기존에 할당 받은 frame은 사용할 수 없음으로 우선 해제
-	  frame = vm_evict_frame();			// 해제 후 축출한 frame(victim) 정보 가져오기
+	  frame = vm_evict_frame(NULL);		// 해제 후 축출한 frame(victim) 정보 가져오기
+	}
+
+	/* Project 3. OOM : 스왑까지 가득 차 축출할 수 없다면 가장 많이 쓰는 프로세스를 종료하고 다시 시도
+	 * 현재 프로세스가 선택되면 실패를 리턴하고, 락을 잡고 있지 않은 시점 (폴트 처리 실패, 시스템 콜 종료)에서 종료 */
+	while (frame == NULL) {
+	  if (!vm_oom_kill ())
+		return NULL;
+	  void *kva = palloc_get_page (PAL_USER);
+	  if (kva != NULL) {
+		frame = malloc (sizeof *frame);
+		frame->kva = kva;
+		frame->page = NULL;
+	  } else
+		frame = vm_evict_frame (NULL);
 	}
 
 	ASSERT (frame->kva != NULL);
@@ -264,12 +509,12 @@ vm_stack_growth (void *addr UNUSED) {
 	void *stack_bottom = pg_round_down (addr);									// 늘려을 때의 스택 바닥 주소
 	size_t req_stack_size = USER_STACK - (uintptr_t)stack_bottom;				// 늘렸을 때의 스택 영역 사이즈
 
-	if (req_stack_size > (1 << 20)) PANIC("Stack limit exceeded!\n");			// 해당 프로젝트에서는 스택의 영역을 1MB로 제한
+	if (req_stack_size > STACK_LIMIT) PANIC("Stack limit exceeded!\n");			// 해당 프로젝트에서는 스택의 영역을 1MB로 제한
 
 	void *growing_stack_bottom = stack_bottom;									// 늘려주기 위한 보조 장치
 	
 	while ((uintptr_t) growing_stack_bottom < USER_STACK &&						// 늘렸을 때의 스택 바닥 주소가 USER_STACK 보단 작아야 함
-		vm_alloc_page (VM_ANON | VM_MARKER_0, growing_stack_bottom, true)) {	// vm_alloc_page를 통해 할당 받아야 함
+		vm_alloc_page (VM_ANON | VM_MARKER_0 | VM_ZERO_FILL, growing_stack_bottom, true)) {	// vm_alloc_page를 통해 할당 받아야 함
 
 		/* 할당이 완료되면 growing_stack_bottom의 높이를 한 페이지 만큼 올려줌 */
 		/* 이는 여러 페이지를 늘렸을 때 최하단부터 하나씩 늘리기 위함 - 최대 늘렸을 때의 유효성을 체크하기 위함 인듯 */
@@ -280,11 +525,52 @@ vm_stack_growth (void *addr UNUSED) {
 	vm_claim_page(stack_bottom);												// 요청한 페이지에 대해서 Lazy laod
 }
 
+/* Project 3. KSM : 병합된 페이지에 대한 쓰기 시 개인 프레임으로 복사 (copy-on-write) */
+static bool
+vm_ksm_break (struct page *page) {
+	struct frame *frame = vm_get_frame ();
+	if (frame == NULL)
+		return false;
+	memcpy (frame->kva, page->frame->kva, PGSIZE);							// 병합 프레임은 주인만 해제하므로 아직 유효
+	ksm_unmerge (page);
+
+	frame->page = page;
+	page->frame = frame;
+	lock_acquire (&clock_lock);
+	vm_frame_link (frame);
+	lock_release (&clock_lock);
+
+	return pml4_set_page (thread_current ()->pml4, page->va, frame->kva, true);
+}
+
+/* Project 3. ZP : PAGE가 공유 zero page에 매핑되어 있는지 확인 */
+bool
+vm_is_zero_mapped (struct page *page) {
+	uint64_t *pml4 = thread_current ()->pml4;
+	return pml4 != NULL && page->frame == NULL
+		&& pml4_get_page (pml4, page->va) == zero_page_kva;
+}
+
+/* Project 3. ZP : 아직 로드되지 않은 zero-fill 페이지에 공유 zero page를 읽기 전용으로 매핑 */
+static bool
+vm_map_zero_page (struct page *page) {
+	return pml4_set_page (thread_current ()->pml4, page->va, zero_page_kva, false);
+}
+
 /* Project 3. AP : 기본적인 핸들링 내용 추가 */
 /* Handle the fault on write_protected page */
 static bool
 vm_handle_wp (struct page *page UNUSED) {
-	return false;
+	/* Project 3. KSM : 병합된 페이지라면 공유를 끊고 쓰기 가능하게 */
+	if (page->writable && VM_TYPE (page->operations->type) == VM_ANON && page->anon.ksm != NULL)
+		return vm_ksm_break (page);
+
+	/* Project 3. ZP : zero page에 매핑된 페이지에 대한 첫 쓰기라면 개인 프레임 할당 */
+	if (!page->writable || !vm_is_zero_mapped (page))
+		return false;
+
+	pml4_clear_page (thread_current ()->pml4, page->va);					// zero page 매핑 해제 후 일반적인 claim 진행
+	return vm_do_claim_page (page);
 }
 
 /* Project 3. AP : 폴트 발생한 주소에 상응하는 page 구조체 찾고 해결하는 함수 구현 */
@@ -312,7 +598,8 @@ vm_try_handle_fault (struct intr_frame *f UNUSED, void *addr UNUSED,
 	 * 3) addr가 USER_STACK 보다 밑에 있는 지 여부
 	 *
 	 */
-	if (write && (stack_bottom - PGSIZE <= addr && (uintptr_t) addr < USER_STACK)) {
+	/* Project 3. KSM : 읽기 전용으로 매핑된 (병합된) 스택 페이지에 대한 쓰기는 vm_handle_wp에서 처리 */
+	if (write && not_present && (stack_bottom - PGSIZE <= addr && (uintptr_t) addr < USER_STACK)) {
 	  /* Allow stack growth writing below single PGSIZE range
 	   * of current stack bottom inferred from stack pointer. */
 	  vm_stack_growth (addr);
@@ -324,9 +611,177 @@ vm_try_handle_fault (struct intr_frame *f UNUSED, void *addr UNUSED,
 	if (page == NULL) return false;												// 페이지를 못 찾았을 경우 false 리턴
 	if (write && !not_present) return vm_handle_wp(page);						// write_protected page인 경우 핸들링
 
+	/* Project 3. ZP : 아직 내용이 전부 0인 페이지를 읽는 경우에는 프레임 할당 없이 zero page 매핑 */
+	if (!write && page->operations->type == VM_UNINIT && (page->uninit.type & VM_ZERO_FILL))
+		return vm_map_zero_page (page);
+
 	return vm_do_claim_page (page);
 }
 
+/* Project 3. MADV : madvise 시스템 콜 처리. 주소 범위는 syscall에서 검증 */
+void
+vm_madvise (void *addr, size_t length, int advice) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	void *end = pg_round_up ((uint8_t *) addr + length);
+
+	for (void *va = addr; va < end; va += PGSIZE) {
+		switch (advice) {
+		case MADV_NORMAL:
+		case MADV_RANDOM:
+		case MADV_SEQUENTIAL: {													// 범위에 걸친 영역 전체의 접근 패턴 변경
+			struct vma *vma = vma_find (&spt->vmas, va);
+			if (vma != NULL) {
+				vma->advice = advice;
+				va = vma->end - PGSIZE;										// 영역의 나머지는 건너 뜀
+			}
+			break;
+		}
+		case MADV_WILLNEED: {													// 아직 메모리에 없는 페이지를 미리 읽음
+			struct page *page = spt_find_page (spt, va);
+			if (page == NULL || page->frame != NULL || vm_is_zero_mapped (page))
+				break;
+			if (page->operations->type == VM_UNINIT && (page->uninit.type & VM_ZERO_FILL))
+				break;														// 0으로 채울 페이지는 미리 읽을 것이 없음
+			vm_do_claim_page (page);
+			break;
+		}
+		case MADV_DONTNEED: {													// 프레임과 스왑 슬롯을 바로 반환
+			struct page *page = spt_lookup (spt, va);						// 만들어지지 않은 페이지는 만들지 않음
+			if (page == NULL || page->operations->type == VM_UNINIT)
+				break;
+
+			bool stack = page->vma == NULL;
+			bool writable = page->writable;
+			spt_remove_page (spt, page);									// 영역의 페이지는 다음 폴트 때 영역 정보로 다시 만들어 짐
+			if (stack)
+				vm_alloc_page (VM_ANON | VM_MARKER_0 | VM_ZERO_FILL, va, writable);	// 스택 페이지는 0으로 채워진 페이지로 다시 시작
+			break;
+		}
+		}
+	}
+}
+
+/* Project 3. POPULATE : mmap의 MAP_POPULATE 처리. [ADDR, ADDR + LENGTH)의 페이지를 미리 모두 claim
+ * 파일 영역은 fault-around 윈도우를 최대로 하여 이어지는 페이지를 큰 read로 한 번에 읽음 */
+void
+vm_populate (void *addr, size_t length) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	void *end = pg_round_up ((uint8_t *) addr + length);
+	struct vma *vma = vma_find (&spt->vmas, addr);
+	int advice = vma != NULL ? vma->advice : MADV_NORMAL;
+
+	if (vma != NULL)
+		vma->advice = MADV_SEQUENTIAL;
+	for (void *va = addr; va < end; va += PGSIZE) {
+		struct page *page = spt_find_page (spt, va);
+		if (page == NULL || page->frame != NULL || vm_is_zero_mapped (page))
+			continue;														// fault-around로 이미 올라온 페이지
+		if (!vm_do_claim_page (page))
+			break;															// 메모리가 부족하면 나머지는 폴트 때 로드
+	}
+	if (vma != NULL)
+		vma->advice = advice;
+}
+
+/* Project 3. HEAP : 힙 영역의 UPAGE에 처음 접근할 때 0으로 채워질 페이지 생성 */
+static bool
+heap_materialize (struct vma *vma UNUSED, void *upage) {
+	return vm_alloc_page (VM_ANON | VM_ZERO_FILL, upage, true);
+}
+
+/* Project 3. HEAP : 힙 영역 (fork 시 자식에게 복사) */
+static const struct vma_operations heap_vma_ops = {
+	.materialize = heap_materialize,
+	.inherit = true,
+};
+
+/* Project 3. HEAP : sbrk 시스템 콜 처리. 힙의 끝을 INCREMENT만큼 옮기고 이전 끝 주소 리턴 (실패 시 -1)
+ * 영역만 늘리고 페이지는 폴트 때 만들어지며, 줄어든 부분의 페이지는 바로 해제 */
+void *
+vm_sbrk (intptr_t increment) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	uint8_t *old_brk = spt->brk, *new_brk = old_brk + increment;
+
+	if (spt->heap_start == NULL)
+		return (void *) -1;
+	if (increment < 0 ? (new_brk < (uint8_t *) spt->heap_start || new_brk > old_brk)
+			: (new_brk < old_brk || new_brk > (uint8_t *) USER_STACK - STACK_LIMIT))	// 오버플로우와 스택 영역 침범 방지
+		return (void *) -1;
+
+	void *old_end = pg_round_up (old_brk), *new_end = pg_round_up (new_brk);
+	struct vma *vma = old_end > spt->heap_start ? vma_find (&spt->vmas, spt->heap_start) : NULL;
+
+	if (new_end > old_end) {
+		if (vma_overlaps (&spt->vmas, old_end, new_end))						// mmap 영역과 겹치면 안됨
+			return (void *) -1;
+		if (vma != NULL)
+			vma->end = new_end;													// 시작 주소는 그대로이므로 트리 재배치 불필요
+		else {
+			vma = malloc (sizeof *vma);
+			if (vma == NULL)
+				return (void *) -1;
+			vma->start = spt->heap_start;
+			vma->end = new_end;
+			vma->file = NULL;
+			vma->ofs = 0;
+			vma->file_bytes = 0;
+			vma->writable = true;
+			vma->ops = &heap_vma_ops;
+			vma->advice = MADV_NORMAL;
+			if (!vma_insert (&spt->vmas, vma)) {
+				free (vma);
+				return (void *) -1;
+			}
+		}
+	} else if (new_end < old_end) {
+		struct list_elem *e = list_begin (&vma->pages);
+		while (e != list_end (&vma->pages)) {									// 줄어든 부분의 페이지만 해제
+			struct page *page = list_entry (e, struct page, vma_elem);
+			e = list_next (e);
+			if (page->va >= new_end)
+				spt_remove_page (spt, page);
+		}
+
+		if (new_end == spt->heap_start) {										// 힙이 비면 영역 제거
+			vma_remove (&spt->vmas, vma);
+			free (vma);
+		} else
+			vma->end = new_end;
+	}
+
+	spt->brk = new_brk;
+	return old_brk;
+}
+
+/* Project 3. FA : fault-around 대상이 될 이웃 페이지 수집 */
+/* PAGE 바로 뒤에 이어지는 페이지들 중 아직 로드되지 않았고 (UNINIT)
+ * 같은 INIT 함수로 로드 될 페이지들을 최대 MAX - 1개까지 PAGES에 담고 그 개수를 리턴.
+ * 연속된 파일 위치인지 등은 각 lazy load 함수가 판단 */
+size_t
+vm_collect_fault_around (struct page *page, vm_initializer *init,
+		struct page **pages, size_t max) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	size_t window = vm_fault_around_pages < max ? vm_fault_around_pages : max;	// 폴트 난 페이지 포함 윈도우 크기
+	size_t cnt = 0;
+
+	/* Project 3. MADV : 영역의 접근 패턴에 따라 윈도우 크기 조절 */
+	if (page->vma != NULL && page->vma->advice == MADV_RANDOM)
+		window = 1;
+	else if (page->vma != NULL && page->vma->advice == MADV_SEQUENTIAL)
+		window = max;
+
+	for (size_t i = 1; i < window; i++) {
+		void *va = page->va + i * PGSIZE;
+		if (!is_user_vaddr (va)) break;
+
+		struct page *p = spt_find_page (spt, va);
+		if (p == NULL || p->operations->type != VM_UNINIT || p->uninit.init != init)	// 이미 로드 되었거나 다른 종류면 중단
+			break;
+		pages[cnt++] = p;
+	}
+	return cnt;
+}
+
 /* Free the page.
  * DO NOT MODIFY THIS FUNCTION. */
 void
@@ -351,21 +806,28 @@ vm_claim_page (void *va UNUSED) {
 /* Claim the PAGE and set up the mmu. */
 static bool
 vm_do_claim_page (struct page *page) {
+	/* Project 3. ST : 다른 프로세스가 올려 둔 같은 text 프레임이 있다면 그대로 매핑 */
+	if (text_attach (page)) {
+		vm_rss_adjust (thread_current (), 1, 0);					// Project 3. RSS : 상주 페이지 수 증가
+		return true;
+	}
+
 	struct frame *frame = vm_get_frame ();							// 프레임 할당 받기
 	struct thread *curr = thread_current ();						// 실행 중인 스레드 정보 받기
 
 	ASSERT (page != NULL);											// page valid check
-	ASSERT (frame != NULL);											// frame valid check
+	if (frame == NULL)												// Project 3. OOM : 메모리 부족으로 종료 대상이 됨
+		return false;
 
 	/* Set links */
 	frame->page = page;												// frame의 page에 page 할당
 	page->frame = frame;											// page의 frame에 frame 할당
+	vm_rss_adjust (curr, 1, 0);										// Project 3. RSS : 상주 페이지 수 증가
 
 	/* Project 3. Swap In/Out : Clock 알고리즘에 따라 clock_elem 확인 후 frame_list에 넣을 위치 정함 */
-	if (clock_elem != NULL)
-		list_insert (clock_elem, &frame->elem);						// clock_elem 존재 시 그 전에 위치 시킴
-	else
-		list_push_back (&frame_list, &frame->elem);					// 없으면 기존과 동일하게 frame 리스트에 추가
+	lock_acquire (&clock_lock);
+	vm_frame_link (frame);											// clock_elem 존재 시 그 전에, 없으면 리스트 끝에 위치 시킴
+	lock_release (&clock_lock);
 
 	/* TODO: Insert page table entry to map page's VA to frame's PA. */
 	/* page의 virtual address를 frame의 physical address로 맵핑하기 위해 page table entry 삽입 */
@@ -399,6 +861,8 @@ supplemental_page_table_init (struct supplemental_page_table *spt UNUSED) {
 	struct hash* page_table = malloc(sizeof(struct hash));		// page_table을 위한 메모리 할당 (커널 영역에 저장)
 	hash_init(page_table, page_hash, page_less, NULL);			// page_table 초기화
 	spt->page_table = page_table;								// spt의 page_table에 저장
+	vma_tree_init (&spt->vmas);									// Project 3. VMA : 영역 트리 초기화
+	spt->heap_start = spt->brk = NULL;							// Project 3. HEAP : 실행 파일을 로드할 때 설정
 }
 
 /* Project 3. AP : SPT-REVISIT 작업 진행 */
@@ -406,6 +870,12 @@ supplemental_page_table_init (struct supplemental_page_table *spt UNUSED) {
 bool
 supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED,
 		struct supplemental_page_table *src UNUSED) {
+
+	/* Project 3. VMA : 아직 폴트가 나지 않은 페이지는 영역 정보만 복사 */
+	if (!vma_tree_copy (&dst->vmas, &src->vmas))
+		return false;
+	dst->heap_start = src->heap_start;															// Project 3. HEAP : 힙 영역은 vma_tree_copy로 복사 됨
+	dst->brk = src->brk;
 	
 	struct hash_iterator i;
 	hash_first(&i, src->page_table);															// spt 내 모든 페이지를 돌기 위한 세팅
@@ -417,16 +887,17 @@ supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED,
 			vm_initializer *init = page->uninit.init;											// UNINIT 내 세팅해 놓은 initializer 가져오기
 			bool writable = page->writable;
 			int type = page->uninit.type;
-			if (type & VM_ANON) {																// 기존 세팅 값이 ANON인 경우
-				struct load_info* li = malloc (sizeof (struct load_info));						// uninit의 initialize 진행
-				li->file = file_duplicate (((struct load_info *)page->uninit.aux)->file);
-				li->page_read_bytes = ((struct load_info *)page->uninit.aux)->page_read_bytes;
-				li->page_zero_bytes = ((struct load_info *)page->uninit.aux)->page_zero_bytes;
-				li->ofs = ((struct load_info *) page->uninit.aux)->ofs;
-				vm_alloc_page_with_initializer (type, page->va, writable, init, (void*)li);				
+			/* Project 3. SPT : 읽을 위치 등은 자식의 영역 (vma_tree_copy로 복사됨)으로부터 계산하므로 initializer만 복사 */
+			if ((type & VM_ANON) || (type & VM_SHARED_TEXT)) {									// 세그먼트, 힙, 스택, 공유 text 페이지
+				if (!vm_alloc_page_with_initializer (type, page->va, writable, init, NULL))
+					return false;
 			} else if (type & VM_FILE) {														// 기존 세팅 값이 FILE인 경우 (아무것도 안함)
 				// Do nothing (should not inherit)
 			}
+		/* Project 3. ST : 이미 로드된 text 페이지는 lazy load로 등록해 두고 첫 폴트 때 부모의 프레임을 공유 */
+		} else if (page->operations->type & VM_SHARED_TEXT) {
+			if (!vm_alloc_page_with_initializer (page->operations->type, page->va, page->writable, NULL, NULL))
+				return false;
 		/* Handle ANON pages */
 		} else if (page_get_type(page) == VM_ANON){												// 해당 페이지가 ANON 페이지인 경우
 
@@ -454,6 +925,7 @@ static void
 spt_destroy (struct hash_elem *e, void *aux UNUSED){
 	struct page *page = hash_entry (e, struct page, hash_elem);					// 해시 엔트리로 페이지 가져오기
 	ASSERT (page != NULL);														// PAGE가 이미 NULL이면 ASSERT
+	vm_rss_forget (page);														// Project 3. RSS : 사용량에서 제외
 	destroy (page);																// PAGE 삭제
 	free (page);																// PAGE 해제
 }
@@ -469,5 +941,6 @@ supplemental_page_table_kill (struct supplemental_page_table *spt UNUSED) {
 	lock_acquire(&spt_kill_lock);												// 작업 전 lock 획득
 	hash_destroy(spt->page_table, spt_destroy);									// page_table 돌아다니며 spt_destroy 진행
 	free(spt->page_table);														// 진행 후 page_table 해제
+	vma_tree_destroy (&spt->vmas);												// Project 3. VMA : 영역 해제
 	lock_release(&spt_kill_lock);												// 작업 전 lock 반환
 }
\ No newline at end of file
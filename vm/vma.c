@@ -0,0 +1,218 @@
+/* vma.c: Per-process virtual memory areas kept in an AVL tree. */
+
+#include "vm/vma.h"
+#include <debug.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/vaddr.h"
+
+/* Project 3. VMA : 영역끼리 겹치지 않으므로 시작 주소를 키로 하는 AVL 트리 하나로
+ * 주소가 속한 영역 검색, 삽입, 삭제 모두 O(log n) */
+
+static int
+vma_height (struct vma *n) {
+	return n != NULL ? n->height : 0;
+}
+
+static void
+vma_update (struct vma *n) {
+	int l = vma_height (n->left), r = vma_height (n->right);
+	n->height = (l > r ? l : r) + 1;
+}
+
+static struct vma *
+vma_rotate_right (struct vma *n) {
+	struct vma *l = n->left;
+	n->left = l->right;
+	l->right = n;
+	vma_update (n);
+	vma_update (l);
+	return l;
+}
+
+static struct vma *
+vma_rotate_left (struct vma *n) {
+	struct vma *r = n->right;
+	n->right = r->left;
+	r->left = n;
+	vma_update (n);
+	vma_update (r);
+	return r;
+}
+
+/* Project 3. VMA : 서브트리 N의 균형을 맞추고 새 루트 리턴 */
+static struct vma *
+vma_balance (struct vma *n) {
+	vma_update (n);
+	int bf = vma_height (n->left) - vma_height (n->right);
+
+	if (bf > 1) {
+		if (vma_height (n->left->left) < vma_height (n->left->right))
+			n->left = vma_rotate_left (n->left);
+		return vma_rotate_right (n);
+	}
+	if (bf < -1) {
+		if (vma_height (n->right->right) < vma_height (n->right->left))
+			n->right = vma_rotate_right (n->right);
+		return vma_rotate_left (n);
+	}
+	return n;
+}
+
+static struct vma *
+vma_insert_at (struct vma *n, struct vma *vma) {
+	if (n == NULL)
+		return vma;
+	if (vma->start < n->start)
+		n->left = vma_insert_at (n->left, vma);
+	else
+		n->right = vma_insert_at (n->right, vma);
+	return vma_balance (n);
+}
+
+/* Project 3. VMA : 서브트리 N에서 가장 왼쪽 노드를 떼어내고 새 루트 리턴 (떼어낸 노드는 MIN) */
+static struct vma *
+vma_remove_min (struct vma *n, struct vma **min) {
+	if (n->left == NULL) {
+		*min = n;
+		return n->right;
+	}
+	n->left = vma_remove_min (n->left, min);
+	return vma_balance (n);
+}
+
+static struct vma *
+vma_remove_at (struct vma *n, struct vma *vma) {
+	ASSERT (n != NULL);
+
+	if (vma->start < n->start)
+		n->left = vma_remove_at (n->left, vma);
+	else if (vma->start > n->start)
+		n->right = vma_remove_at (n->right, vma);
+	else {
+		struct vma *l = n->left, *r = n->right;
+		if (r == NULL)
+			return l;
+
+		struct vma *min;
+		r = vma_remove_min (r, &min);
+		min->left = l;
+		min->right = r;
+		n = min;
+	}
+	return vma_balance (n);
+}
+
+void
+vma_tree_init (struct vma_tree *tree) {
+	tree->root = NULL;
+	tree->cnt = 0;
+}
+
+/* Project 3. VMA : 주소 VA를 포함하는 영역 검색 (없으면 NULL) */
+struct vma *
+vma_find (struct vma_tree *tree, const void *va) {
+	struct vma *n = tree->root;
+	while (n != NULL) {
+		if (va < n->start)
+			n = n->left;
+		else if (va >= n->end)
+			n = n->right;
+		else
+			return n;
+	}
+	return NULL;
+}
+
+/* Project 3. VMA : [START, END)와 겹치는 영역이 있는지 확인 */
+bool
+vma_overlaps (struct vma_tree *tree, const void *start, const void *end) {
+	struct vma *n = tree->root;
+	while (n != NULL) {
+		if (end <= n->start)
+			n = n->left;
+		else if (start >= n->end)
+			n = n->right;
+		else
+			return true;
+	}
+	return false;
+}
+
+/* Project 3. SPT : 영역 내 페이지 UPAGE가 파일에서 읽어야 할 바이트 수 (나머지는 0)
+ * 페이지마다 따로 정보를 저장하지 않고 영역 정보로부터 계산 */
+size_t
+vma_file_bytes_at (const struct vma *vma, const void *upage) {
+	size_t idx = (const uint8_t *) upage - (const uint8_t *) vma->start;
+	if (idx >= vma->file_bytes)
+		return 0;
+	return vma->file_bytes - idx < PGSIZE ? vma->file_bytes - idx : PGSIZE;
+}
+
+/* Project 3. VMA : 영역 추가. 기존 영역과 겹치면 false 리턴 */
+bool
+vma_insert (struct vma_tree *tree, struct vma *vma) {
+	ASSERT (vma->start < vma->end);
+
+	list_init (&vma->pages);										// Project 3. MR : 아직 만들어진 페이지 없음
+	if (vma_overlaps (tree, vma->start, vma->end))
+		return false;
+
+	vma->left = vma->right = NULL;
+	vma->height = 1;
+	tree->root = vma_insert_at (tree->root, vma);
+	tree->cnt++;
+	return true;
+}
+
+/* Project 3. VMA : 영역을 트리에서 제거 (해제는 하지 않음) */
+void
+vma_remove (struct vma_tree *tree, struct vma *vma) {
+	tree->root = vma_remove_at (tree->root, vma);
+	tree->cnt--;
+}
+
+static bool
+vma_copy_at (struct vma_tree *dst, struct vma *n) {
+	if (n == NULL)
+		return true;
+	if (!vma_copy_at (dst, n->left) || !vma_copy_at (dst, n->right))
+		return false;
+	if (!n->ops->inherit)
+		return true;
+
+	struct vma *vma = malloc (sizeof *vma);
+	if (vma == NULL)
+		return false;
+	*vma = *n;
+	vma->file = n->file != NULL ? file_duplicate (n->file) : NULL;	// Project 3. POPULATE : 어나니머스 영역은 파일이 없음
+	if ((n->file != NULL && vma->file == NULL) || !vma_insert (dst, vma)) {
+		file_close (vma->file);
+		free (vma);
+		return false;
+	}
+	return true;
+}
+
+/* Project 3. VMA : fork 시 상속 대상 영역들을 DST로 복사 */
+bool
+vma_tree_copy (struct vma_tree *dst, struct vma_tree *src) {
+	return vma_copy_at (dst, src->root);
+}
+
+static void
+vma_destroy_at (struct vma *n) {
+	if (n == NULL)
+		return;
+	vma_destroy_at (n->left);
+	vma_destroy_at (n->right);
+	file_close (n->file);
+	free (n);
+}
+
+/* Project 3. VMA : 모든 영역 해제 */
+void
+vma_tree_destroy (struct vma_tree *tree) {
+	vma_destroy_at (tree->root);
+	vma_tree_init (tree);
+}
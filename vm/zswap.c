@@ -0,0 +1,293 @@
+/* zswap.c: Compressed in-memory cache in front of the swap disk. */
+
+#include "vm/zswap.h"
+#include <string.h>
+#include "vm/vm.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Project 3. ZSWAP : 압축 결과가 이 크기를 넘으면 저장하지 않고 바로 스왑 디스크로 보냄
+ * (malloc은 PGSIZE / 2 보다 큰 블록을 페이지 단위로 할당하기 때문에 이득이 없음) */
+#define ZSWAP_MAX_LEN (PGSIZE / 2)
+
+/* Project 3. ZSWAP : LZ 압축기에서 사용하는 값 정의 */
+#define ZS_HASH_BITS 12
+#define ZS_MIN_MATCH 4
+#define ZS_LAST_LITERALS 5			// 페이지 마지막 몇 바이트는 항상 literal로 남김
+#define ZS_MAX_OFFSET 0xFFFF
+
+static struct lock zswap_lock;		// 풀과 LRU 리스트 보호를 위한 lock
+static struct list zswap_lru;		// 오래된 순서로 정렬된 압축 엔트리 리스트 (front가 가장 오래됨)
+static size_t zswap_pool_bytes;		// 현재 풀에서 사용 중인 압축 데이터 바이트 수
+static uint8_t *zswap_cbuf;			// 압축 결과를 임시로 담는 버퍼 (ZSWAP_MAX_LEN)
+static uint8_t *zswap_bounce;		// write back 시 압축을 풀어 담는 버퍼 (1 페이지)
+static uint16_t zs_hash_table[1 << ZS_HASH_BITS];	// 압축기가 사용하는 해시 테이블 (zswap_lock으로 보호)
+
+static void zswap_writeback (size_t need);
+static void zswap_free_entry (struct zswap_entry *e);
+
+/* Project 3. ZSWAP : 초기화 */
+void
+zswap_init (void) {
+	lock_init (&zswap_lock);
+	list_init (&zswap_lru);
+	zswap_pool_bytes = 0;
+
+	zswap_cbuf = malloc (ZSWAP_MAX_LEN);
+	zswap_bounce = palloc_get_page (0);								// 커널 풀에서 버퍼 할당
+	if (zswap_cbuf == NULL || zswap_bounce == NULL)
+		PANIC ("zswap init failed");
+}
+
+/* Project 3. ZSWAP : 4 바이트 읽기 (정렬되지 않은 주소 대응) */
+static inline uint32_t
+zs_read32 (const uint8_t *p) {
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8)
+		| ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline uint32_t
+zs_hash (uint32_t seq) {
+	return (seq * 2654435761U) >> (32 - ZS_HASH_BITS);
+}
+
+/* Project 3. ZSWAP : 255 단위로 길이를 이어 붙이는 LZ4 방식의 길이 기록 */
+static uint8_t *
+zs_put_length (uint8_t *op, size_t len) {
+	while (len >= 255) {
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = (uint8_t) len;
+	return op;
+}
+
+/* Project 3. ZSWAP : 시퀀스 하나 기록 (literal + match)
+ * MATCH_LEN이 0이면 마지막 시퀀스로 offset을 기록하지 않음.
+ * 출력 공간이 부족하면 NULL 리턴 */
+static uint8_t *
+zs_emit (uint8_t *op, uint8_t *oend, const uint8_t *lit, size_t lit_len,
+		size_t offset, size_t match_len) {
+	size_t ml = match_len ? match_len - ZS_MIN_MATCH : 0;
+	size_t worst = 1 + lit_len / 255 + 1 + lit_len + 2 + ml / 255 + 1;		// 최악의 경우 필요한 바이트 수
+	if (op + worst > oend)
+		return NULL;
+
+	uint8_t *token = op++;
+	*token = (uint8_t) ((lit_len < 15 ? lit_len : 15) << 4);
+	if (lit_len >= 15)
+		op = zs_put_length (op, lit_len - 15);
+	memcpy (op, lit, lit_len);
+	op += lit_len;
+
+	if (match_len == 0)
+		return op;
+
+	*op++ = (uint8_t) (offset & 0xFF);										// offset은 little endian 2 바이트
+	*op++ = (uint8_t) (offset >> 8);
+	*token |= (uint8_t) (ml < 15 ? ml : 15);
+	if (ml >= 15)
+		op = zs_put_length (op, ml - 15);
+	return op;
+}
+
+/* Project 3. ZSWAP : 한 페이지(SRC)를 DST에 압축. 압축 길이를 리턴하며 CAP을 넘으면 0 리턴
+ * 해시 테이블을 사용하므로 zswap_lock을 가진 상태에서 호출해야 함 */
+static size_t
+zs_compress (const uint8_t *src, uint8_t *dst, size_t cap) {
+	const uint8_t *ip = src;
+	const uint8_t *anchor = src;											// 아직 기록하지 않은 literal의 시작
+	const uint8_t *const end = src + PGSIZE;
+	const uint8_t *const mflimit = end - ZS_LAST_LITERALS - ZS_MIN_MATCH;
+	uint8_t *op = dst;
+	uint8_t *const oend = dst + cap;
+
+	memset (zs_hash_table, 0, sizeof zs_hash_table);
+
+	while (ip < mflimit) {
+		uint32_t seq = zs_read32 (ip);
+		uint32_t h = zs_hash (seq);
+		const uint8_t *ref = src + zs_hash_table[h];						// 같은 해시를 가졌던 이전 위치
+		zs_hash_table[h] = (uint16_t) (ip - src);
+
+		if (ref >= ip || ip - ref > ZS_MAX_OFFSET || zs_read32 (ref) != seq) {
+			ip++;
+			continue;
+		}
+
+		/* 매치 길이 늘리기 */
+		const uint8_t *mp = ip + ZS_MIN_MATCH;
+		const uint8_t *rp = ref + ZS_MIN_MATCH;
+		while (mp < end - ZS_LAST_LITERALS && *mp == *rp) {
+			mp++;
+			rp++;
+		}
+
+		op = zs_emit (op, oend, anchor, ip - anchor, ip - ref, mp - ip);
+		if (op == NULL)
+			return 0;
+		ip = anchor = mp;
+	}
+
+	op = zs_emit (op, oend, anchor, end - anchor, 0, 0);					// 남은 literal 기록
+	return op != NULL ? (size_t) (op - dst) : 0;
+}
+
+/* Project 3. ZSWAP : 길이 읽기 (zs_put_length의 역) */
+static const uint8_t *
+zs_get_length (const uint8_t *ip, size_t *len) {
+	uint8_t b;
+	do {
+		b = *ip++;
+		*len += b;
+	} while (b == 255);
+	return ip;
+}
+
+/* Project 3. ZSWAP : 압축된 SRC (LEN 바이트)를 한 페이지 크기의 DST로 복원 */
+static void
+zs_decompress (const uint8_t *src, size_t len, uint8_t *dst) {
+	const uint8_t *ip = src;
+	const uint8_t *const iend = src + len;
+	uint8_t *op = dst;
+
+	while (ip < iend) {
+		uint8_t token = *ip++;
+		size_t lit_len = token >> 4;
+		if (lit_len == 15)
+			ip = zs_get_length (ip, &lit_len);
+		memcpy (op, ip, lit_len);
+		op += lit_len;
+		ip += lit_len;
+		if (ip >= iend)														// 마지막 시퀀스는 literal만 가짐
+			break;
+
+		size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		size_t match_len = token & 0xF;
+		if (match_len == 15)
+			ip = zs_get_length (ip, &match_len);
+		match_len += ZS_MIN_MATCH;
+
+		const uint8_t *ref = op - offset;									// 겹칠 수 있으므로 한 바이트씩 복사
+		while (match_len-- > 0)
+			*op++ = *ref++;
+	}
+	ASSERT (op == dst + PGSIZE);
+}
+
+/* Project 3. ZSWAP : 페이지가 모두 0인지 확인 */
+static bool
+zs_is_zero_page (const void *kva) {
+	const uint64_t *p = kva;
+	for (size_t i = 0; i < PGSIZE / sizeof *p; i++)
+		if (p[i] != 0)
+			return false;
+	return true;
+}
+
+/* Project 3. ZSWAP : 스왑 아웃 되는 PAGE의 내용(KVA)을 압축하여 풀에 저장
+ * 성공 시 true 리턴. 압축 효과가 없거나 풀을 비울 수 없으면 false를 리턴하고
+ * 호출한 쪽에서 스왑 디스크로 내보냄 */
+bool
+zswap_store (struct page *page, const void *kva) {
+	struct zswap_entry *e = malloc (sizeof *e);
+	if (e == NULL)
+		return false;
+
+	e->page = page;
+	e->len = 0;
+	e->data = NULL;
+
+	lock_acquire (&zswap_lock);
+
+	if (!zs_is_zero_page (kva)) {											// zero page는 데이터 없이 엔트리만 저장
+		size_t len = zs_compress (kva, zswap_cbuf, ZSWAP_MAX_LEN);
+		if (len == 0)
+			goto fail;														// 압축 효과 없음
+
+		if (zswap_pool_bytes + len > ZSWAP_POOL_MAX)						// 풀이 꽉 찼다면 오래된 엔트리부터 디스크로
+			zswap_writeback (len);
+		if (zswap_pool_bytes + len > ZSWAP_POOL_MAX)
+			goto fail;
+
+		e->data = malloc (len);
+		if (e->data == NULL)
+			goto fail;
+		memcpy (e->data, zswap_cbuf, len);
+		e->len = len;
+		zswap_pool_bytes += len;
+	}
+
+	page->anon.zswap = e;
+	list_push_back (&zswap_lru, &e->lru_elem);								// 가장 최근 엔트리는 뒤쪽
+	lock_release (&zswap_lock);
+	return true;
+
+fail:
+	lock_release (&zswap_lock);
+	free (e);
+	return false;
+}
+
+/* Project 3. ZSWAP : PAGE가 풀에 있다면 KVA로 복원 후 엔트리 해제 및 true 리턴 */
+bool
+zswap_load (struct page *page, void *kva) {
+	lock_acquire (&zswap_lock);
+	struct zswap_entry *e = page->anon.zswap;
+	if (e == NULL) {
+		lock_release (&zswap_lock);
+		return false;
+	}
+
+	if (e->len == 0)
+		memset (kva, 0, PGSIZE);
+	else
+		zs_decompress (e->data, e->len, kva);
+
+	zswap_free_entry (e);
+	lock_release (&zswap_lock);
+	return true;
+}
+
+/* Project 3. ZSWAP : 페이지 삭제 시 풀에 있는 엔트리 해제. 해제했다면 true 리턴 */
+bool
+zswap_invalidate (struct page *page) {
+	lock_acquire (&zswap_lock);
+	struct zswap_entry *e = page->anon.zswap;
+	if (e != NULL)
+		zswap_free_entry (e);
+	lock_release (&zswap_lock);
+	return e != NULL;
+}
+
+/* Project 3. ZSWAP : 엔트리를 LRU에서 빼고 메모리 해제 (zswap_lock 필요) */
+static void
+zswap_free_entry (struct zswap_entry *e) {
+	list_remove (&e->lru_elem);
+	e->page->anon.zswap = NULL;
+	zswap_pool_bytes -= e->len;
+	free (e->data);
+	free (e);
+}
+
+/* Project 3. ZSWAP : NEED 바이트가 들어갈 때까지 LRU 순서로 압축 엔트리를 스왑 디스크에 write back
+ * zero page 엔트리는 풀을 차지하지 않으므로 건너뜀 (zswap_lock 필요) */
+static void
+zswap_writeback (size_t need) {
+	struct list_elem *el = list_begin (&zswap_lru);
+
+	while (zswap_pool_bytes + need > ZSWAP_POOL_MAX && el != list_end (&zswap_lru)) {
+		struct zswap_entry *e = list_entry (el, struct zswap_entry, lru_elem);
+		el = list_next (el);
+		if (e->len == 0)
+			continue;
+
+		zs_decompress (e->data, e->len, zswap_bounce);
+		if (!anon_swap_to_disk (e->page, zswap_bounce))						// 스왑 디스크도 꽉 찬 경우 중단
+			break;
+		zswap_free_entry (e);
+	}
+}